@@ -2,6 +2,7 @@
 #include <AP_Filesystem/AP_Filesystem.h>
 
 #include <fcntl.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
 #include <stdio.h>
@@ -9,6 +10,11 @@
 #include <time.h>
 #include <cinttypes>
 
+#if AP_REPLAY_MMAP_ENABLED
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #ifndef PRIu64
 #define PRIu64 "llu"
 #endif
@@ -19,19 +25,95 @@ AP_LoggerFileReader::AP_LoggerFileReader()
 AP_LoggerFileReader::~AP_LoggerFileReader()
 {
     ::printf("Replay counts: %" PRIu64 " bytes  %u entries\n", bytes_read, message_count);
+#if AP_REPLAY_MMAP_ENABLED
+    if (map_base != nullptr) {
+        munmap(map_base, map_length);
+    }
+#endif
+#if HAL_LOGGER_FILE_COMPRESSION_ENABLED
+    delete frame_reader;
+#endif
 }
 
+#if AP_REPLAY_MMAP_ENABLED
+/*
+  map the whole log into our address space. Messages are then parsed
+  in place, avoiding a pair of read() calls and a copy per message
+ */
+bool AP_LoggerFileReader::open_log_mmap(const char *logfile)
+{
+    const int mfd = ::open(logfile, O_RDONLY | O_CLOEXEC);
+    if (mfd == -1) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(mfd, &st) != 0 || st.st_size <= 0) {
+        ::close(mfd);
+        return false;
+    }
+    // private writable mapping as handlers are given a non-const
+    // message pointer; any writes stay in our copy of the page
+    void *base = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, mfd, 0);
+    ::close(mfd);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+#if HAL_LOGGER_FILE_COMPRESSION_ENABLED
+    uint32_t magic = 0;
+    if (size_t(st.st_size) >= sizeof(log_FrameHeader)) {
+        memcpy(&magic, base, sizeof(magic));
+    }
+    if (magic == LOGGER_FRAME_MAGIC) {
+        // compressed logs are streamed through the frame reader
+        // rather than decoded into memory as a whole
+        munmap(base, st.st_size);
+        return false;
+    }
+#endif
+    madvise(base, st.st_size, MADV_SEQUENTIAL);
+    map_base = (uint8_t *)base;
+    map_length = st.st_size;
+    map_offset = 0;
+    return true;
+}
+#endif
+
 bool AP_LoggerFileReader::open_log(const char *logfile)
 {
+#if AP_REPLAY_MMAP_ENABLED
+    if (use_mmap && open_log_mmap(logfile)) {
+        return true;
+    }
+#endif
     fd = AP::FS().open(logfile, O_RDONLY);
     if (fd == -1) {
         return false;
     }
+#if HAL_LOGGER_FILE_COMPRESSION_ENABLED
+    if (AP_Logger_FrameReader::is_compressed(fd)) {
+        frame_reader = new AP_Logger_FrameReader();
+        return frame_reader != nullptr && frame_reader->open(fd);
+    }
+    if (AP::FS().lseek(fd, 0, SEEK_SET) != 0) {
+        return false;
+    }
+#endif
     return true;
 }
 
 ssize_t AP_LoggerFileReader::read_input(void *buffer, const size_t count)
 {
+#if HAL_LOGGER_FILE_COMPRESSION_ENABLED
+    if (frame_reader != nullptr) {
+        const ssize_t n = frame_reader->read(raw_offset, (uint8_t *)buffer, count);
+        if (n <= 0) {
+            return n;
+        }
+        raw_offset += n;
+        bytes_read += n;
+        return n;
+    }
+#endif
     uint64_t ret = AP::FS().read(fd, buffer, count);
     bytes_read += ret;
     return ret;
@@ -51,8 +133,61 @@ void AP_LoggerFileReader::get_packet_counts(uint64_t dest[])
     memcpy(dest, packet_counts, sizeof(packet_counts));
 }
 
+#if AP_REPLAY_MMAP_ENABLED
+bool AP_LoggerFileReader::update_mmap()
+{
+    const size_t remaining = map_length - map_offset;
+    if (remaining < 3) {
+        return false;
+    }
+    uint8_t *hdr = &map_base[map_offset];
+    if (hdr[0] != HEAD_BYTE1 || hdr[1] != HEAD_BYTE2) {
+        printf("bad log header\n");
+        return false;
+    }
+
+    packet_counts[hdr[2]]++;
+
+    if (hdr[2] == LOG_FORMAT_MSG) {
+        struct log_Format f;
+        if (remaining < sizeof(f)) {
+            return false;
+        }
+        memcpy(&f, hdr, sizeof(f));
+        memcpy(&formats[f.type], &f, sizeof(formats[f.type]));
+        map_offset += sizeof(f);
+        bytes_read += sizeof(f);
+
+        message_count++;
+        return handle_log_format_msg(f);
+    }
+
+    const struct log_Format &f = formats[hdr[2]];
+    if (f.length == 0) {
+        // can't just throw these away as the format specifies the
+        // number of bytes in the message
+        ::printf("No format defined for type (%d)\n", hdr[2]);
+        exit(1);
+    }
+    if (remaining < f.length) {
+        return false;
+    }
+    map_offset += f.length;
+    bytes_read += f.length;
+
+    message_count++;
+    return handle_msg(f, hdr);
+}
+#endif
+
 bool AP_LoggerFileReader::update()
 {
+#if AP_REPLAY_MMAP_ENABLED
+    if (map_base != nullptr) {
+        return update_mmap();
+    }
+#endif
+
     uint8_t hdr[3];
     if (read_input(hdr, 3) != 3) {
         return false;
@@ -1,9 +1,14 @@
 #pragma once
 
 #include <AP_Logger/AP_Logger.h>
+#include <AP_Logger/AP_Logger_Compress.h>
 
 #define LOGREADER_MAX_FORMATS 255 // must be >= highest MESSAGE
 
+#ifndef AP_REPLAY_MMAP_ENABLED
+#define AP_REPLAY_MMAP_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
 class AP_LoggerFileReader
 {
 public:
@@ -14,6 +19,10 @@ public:
     bool open_log(const char *logfile);
     bool update();
 
+    // when set before open_log() the log is read through AP_Filesystem
+    // rather than being mapped into memory
+    void set_use_mmap(bool enable) { use_mmap = enable; }
+
     virtual bool handle_log_format_msg(const struct log_Format &f) = 0;
     virtual bool handle_msg(const struct log_Format &f, uint8_t *msg) = 0;
 
@@ -28,6 +37,23 @@ protected:
 private:
     ssize_t read_input(void *buf, size_t count);
 
+#if AP_REPLAY_MMAP_ENABLED
+    bool open_log_mmap(const char *logfile);
+    bool update_mmap();
+
+    // mapped log file; messages are handed to handlers in place
+    uint8_t *map_base = nullptr;
+    size_t map_length = 0;
+    size_t map_offset = 0;
+#endif
+#if HAL_LOGGER_FILE_COMPRESSION_ENABLED
+    // decoding of a compressed log read through fd. Compressed logs
+    // are limited to 4GB, see log_FrameHeader
+    AP_Logger_FrameReader *frame_reader = nullptr;
+    uint32_t raw_offset = 0;
+#endif
+    bool use_mmap = true;
+
     uint64_t bytes_read = 0;
     uint32_t message_count = 0;
     uint64_t start_micros;
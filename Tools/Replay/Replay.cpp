@@ -31,6 +31,16 @@
 #include <AP_HAL_Linux/Scheduler.h>
 #endif
 
+#if AP_REPLAY_BATCH_ENABLED
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 #define streq(x, y) (!strcmp(x, y))
 
 static ReplayVehicle replayvehicle;
@@ -130,11 +140,21 @@ void Replay::usage(void)
     ::printf("\t--param-file FILENAME  load parameters from a file\n");
     ::printf("\t--force-ekf2 force enable EKF2\n");
     ::printf("\t--force-ekf3 force enable EKF3\n");
+    ::printf("\t--no-mmap read the log with file reads instead of mapping it\n");
+#if AP_REPLAY_BATCH_ENABLED
+    ::printf("\t--batch FILENAME  replay each line of FILENAME (LOGFILE [NAME=VALUE...])\n");
+    ::printf("\t--jobs N  number of batch jobs to run at once (default: number of CPUs)\n");
+    ::printf("\t--batch-dir DIRECTORY  directory for per-job output (default: replay-batch)\n");
+#endif
 }
 
 enum param_key : uint8_t {
     FORCE_EKF2 = 1,
     FORCE_EKF3,
+    NO_MMAP,
+    BATCH,
+    BATCH_JOBS,
+    BATCH_DIR,
 };
 
 void Replay::_parse_command_line(uint8_t argc, char * const argv[])
@@ -146,6 +166,10 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
         {"param-file",      true,   0, 'F'},
         {"force-ekf2",      false,  0, param_key::FORCE_EKF2},
         {"force-ekf3",      false,  0, param_key::FORCE_EKF3},
+        {"no-mmap",         false,  0, param_key::NO_MMAP},
+        {"batch",           true,   0, param_key::BATCH},
+        {"jobs",            true,   0, param_key::BATCH_JOBS},
+        {"batch-dir",       true,   0, param_key::BATCH_DIR},
         {"help",            false,  0, 'h'},
         {0, false, 0, 0}
     };
@@ -181,6 +205,30 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
             replay_force_ekf3 = true;
             break;
 
+        case param_key::NO_MMAP:
+            reader.set_use_mmap(false);
+            break;
+
+#if AP_REPLAY_BATCH_ENABLED
+        case param_key::BATCH:
+            load_batch_file(gopt.optarg);
+            break;
+
+        case param_key::BATCH_JOBS: {
+            const long jobs = strtol(gopt.optarg, nullptr, 10);
+            if (jobs <= 0 || jobs > UINT16_MAX) {
+                ::printf("Invalid --jobs %s\n", gopt.optarg);
+                exit(1);
+            }
+            batch_workers = jobs;
+            break;
+        }
+
+        case param_key::BATCH_DIR:
+            batch_dir = gopt.optarg;
+            break;
+#endif
+
         case 'h':
         default:
             usage();
@@ -209,6 +257,14 @@ void Replay::setup()
         _parse_command_line(argc, argv);
     }
 
+#if AP_REPLAY_BATCH_ENABLED
+    if (batch_jobs != nullptr) {
+        // only returns in a worker process, with filename and
+        // user_parameters set up for that worker's job
+        run_batch();
+    }
+#endif
+
     _vehicle.setup();
 
     set_user_parameters();
@@ -319,6 +375,209 @@ void Replay::load_param_file(const char *pfilename)
     fclose(f);
 }
 
+#if AP_REPLAY_BATCH_ENABLED
+/*
+  wall clock time for batch job timing; AP_HAL::millis() follows the
+  log being replayed rather than the host
+ */
+static uint32_t batch_wall_ms()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint32_t(ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000ULL);
+}
+
+/*
+  load a batch file. Each line holds a log filename followed by
+  optional NAME=VALUE parameter overrides for that log
+ */
+void Replay::load_batch_file(const char *bfilename)
+{
+    FILE *f = fopen(bfilename, "r");
+    if (f == NULL) {
+        printf("Failed to open batch file: %s\n", bfilename);
+        exit(1);
+    }
+    char line[1024];
+    struct replay_job **tail = &batch_jobs;
+
+    while (fgets(line, sizeof(line)-1, f)) {
+        char *saveptr = NULL;
+        const char *logname = strtok_r(line, " \t\r\n", &saveptr);
+        if (logname == NULL || logname[0] == '#') {
+            continue;
+        }
+        struct replay_job *job = new replay_job {};
+        job->logfile = strdup(logname);
+        job->status = -1;
+        char *token;
+        while ((token = strtok_r(NULL, " \t\r\n", &saveptr)) != NULL) {
+            char *pname;
+            float value;
+            if (!parse_param_line(token, &pname, value)) {
+                printf("Bad parameter %s for %s in %s\n", token, logname, bfilename);
+                exit(1);
+            }
+            struct user_parameter *u = new user_parameter;
+            strncpy_noterm(u->name, pname, sizeof(u->name));
+            u->value = value;
+            u->next = job->params;
+            job->params = u;
+        }
+        *tail = job;
+        tail = &job->next;
+    }
+    fclose(f);
+}
+
+/*
+  start one batch job in a child process. The child gets its own
+  directory, so Replay logs from concurrent jobs don't collide, and
+  its output is redirected to a file there
+ */
+void Replay::start_batch_job(struct replay_job &job, uint16_t job_num)
+{
+    char *jobdir;
+    if (asprintf(&jobdir, "%s/job%03u", batch_dir, (unsigned)job_num) == -1) {
+        exit(1);
+    }
+    if (mkdir(jobdir, 0755) != 0 && errno != EEXIST) {
+        ::printf("mkdir(%s): %m\n", jobdir);
+        exit(1);
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    job.start_ms = batch_wall_ms();
+    job.pid = fork();
+    if (job.pid == -1) {
+        ::printf("fork: %m\n");
+        exit(1);
+    }
+    if (job.pid != 0) {
+        free(jobdir);
+        return;
+    }
+
+    // in the worker; make relative log filenames absolute before
+    // moving into the job directory
+    char *logfile = job.logfile;
+    if (logfile[0] != '/') {
+        char cwd[PATH_MAX];
+        if (getcwd(cwd, sizeof(cwd)) == nullptr ||
+            asprintf(&logfile, "%s/%s", cwd, job.logfile) == -1) {
+            _exit(1);
+        }
+    }
+    if (chdir(jobdir) != 0 ||
+        freopen("output.txt", "w", stdout) == nullptr ||
+        dup2(STDOUT_FILENO, STDERR_FILENO) == -1) {
+        _exit(1);
+    }
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+    ::printf("Replaying %s\n", logfile);
+
+    filename = logfile;
+    // job overrides are applied after the command-line parameters
+    // so they take precedence
+    struct user_parameter **tail = &user_parameters;
+    while (*tail != nullptr) {
+        tail = &(*tail)->next;
+    }
+    *tail = job.params;
+}
+
+/*
+  run all batch jobs across a pool of worker processes. Command-line
+  options and parameter files are parsed once; each worker then
+  replays a single log and exits. Returns only in a worker
+ */
+void Replay::run_batch()
+{
+    if (batch_workers == 0) {
+        const long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+        batch_workers = ncpus > 0 ? ncpus : 1;
+    }
+    if (mkdir(batch_dir, 0755) != 0 && errno != EEXIST) {
+        ::printf("mkdir(%s): %m\n", batch_dir);
+        exit(1);
+    }
+
+    uint16_t job_num = 0;
+    uint16_t running = 0;
+    struct replay_job *next_job = batch_jobs;
+
+    while (next_job != nullptr || running > 0) {
+        while (next_job != nullptr && running < batch_workers) {
+            start_batch_job(*next_job, job_num);
+            if (next_job->pid == 0) {
+                return;
+            }
+            ::printf("job%03u: started %s (pid %d)\n", (unsigned)job_num, next_job->logfile, next_job->pid);
+            job_num++;
+            running++;
+            next_job = next_job->next;
+        }
+        int status;
+        const pid_t pid = waitpid(-1, &status, 0);
+        if (pid == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (struct replay_job *job = batch_jobs; job != next_job; job = job->next) {
+            if (job->pid == pid) {
+                job->status = status;
+                job->elapsed_ms = batch_wall_ms() - job->start_ms;
+                running--;
+                break;
+            }
+        }
+    }
+
+    write_batch_summary(stdout);
+    char *summary_name;
+    if (asprintf(&summary_name, "%s/summary.txt", batch_dir) != -1) {
+        FILE *f = fopen(summary_name, "w");
+        if (f != nullptr) {
+            write_batch_summary(f);
+            fclose(f);
+        }
+        free(summary_name);
+    }
+
+    bool all_ok = true;
+    for (const struct replay_job *job = batch_jobs; job != nullptr; job = job->next) {
+        all_ok &= WIFEXITED(job->status) && WEXITSTATUS(job->status) == 0;
+    }
+    exit(all_ok ? 0 : 1);
+}
+
+void Replay::write_batch_summary(FILE *f) const
+{
+    uint16_t job_num = 0;
+    uint16_t failed = 0;
+    for (const struct replay_job *job = batch_jobs; job != nullptr; job = job->next, job_num++) {
+        const bool ok = WIFEXITED(job->status) && WEXITSTATUS(job->status) == 0;
+        if (!ok) {
+            failed++;
+        }
+        ::fprintf(f, "job%03u %-6s %8.2fs %s",
+                  (unsigned)job_num,
+                  ok ? "OK" : "FAILED",
+                  job->elapsed_ms * 0.001,
+                  job->logfile);
+        for (const struct user_parameter *u = job->params; u; u = u->next) {
+            ::fprintf(f, " %s=%f", u->name, u->value);
+        }
+        ::fprintf(f, "\n");
+    }
+    ::fprintf(f, "Replay batch: %u jobs, %u failed, output in %s\n",
+              (unsigned)job_num, (unsigned)failed, batch_dir);
+}
+#endif  // AP_REPLAY_BATCH_ENABLED
+
 Replay replay(replayvehicle);
 AP_Vehicle& vehicle = replayvehicle;
 
@@ -20,6 +20,12 @@
 
 #define AP_PARAM_VEHICLE_NAME replayvehicle
 
+// batch jobs are forked after HAL init, which is only safe on SITL
+// where the scheduler doesn't start any threads
+#ifndef AP_REPLAY_BATCH_ENABLED
+#define AP_REPLAY_BATCH_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL)
+#endif
+
 struct user_parameter {
     struct user_parameter *next;
     char name[17];
@@ -27,6 +33,19 @@ struct user_parameter {
 };
 
 extern user_parameter *user_parameters;
+
+#if AP_REPLAY_BATCH_ENABLED
+// one line of a --batch file: a log plus its parameter overrides
+struct replay_job {
+    struct replay_job *next;
+    char *logfile;
+    struct user_parameter *params;
+    int pid;
+    int status;
+    uint32_t start_ms;
+    uint32_t elapsed_ms;
+};
+#endif
 extern bool replay_force_ekf2;
 extern bool replay_force_ekf3;
 
@@ -104,4 +123,15 @@ private:
     bool parse_param_line(char *line, char **vname, float &value);
     void load_param_file(const char *filename);
     void usage();
+
+#if AP_REPLAY_BATCH_ENABLED
+    void load_batch_file(const char *bfilename);
+    void run_batch();
+    void start_batch_job(struct replay_job &job, uint16_t job_num);
+    void write_batch_summary(FILE *f) const;
+
+    struct replay_job *batch_jobs = nullptr;
+    const char *batch_dir = "replay-batch";
+    uint16_t batch_workers = 0;
+#endif
 };
@@ -8676,6 +8676,17 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
 
         return current_log_filepath
 
+    def test_replay_parallel_cores_bit(self):
+        # the vehicle updates EKF3 cores in worker threads while
+        # Replay runs them one after another; check_replay then
+        # requires the outputs of every core to match exactly
+        self.set_parameters({
+            "EK3_CORE_THREADS": 1,
+            "EK3_IMU_MASK": 7,
+            "SIM_IMU_COUNT": 3,
+        })
+        return self.test_replay_gps_bit()
+
     def test_replay_beacon_bit(self):
         self.set_parameters({
             "LOG_REPLAY": 1,
@@ -8872,6 +8883,7 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
             ('GPS', self.test_replay_gps_bit),
             ('Beacon', self.test_replay_beacon_bit),
             ('OpticalFlow', self.test_replay_optical_flow_bit),
+            ('ParallelCores', self.test_replay_parallel_cores_bit),
         ]
         for (name, func) in bits:
             self.start_subtest("%s" % name)
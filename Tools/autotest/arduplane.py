@@ -7,6 +7,7 @@ AP_FLAKE8_CLEAN
 from __future__ import print_function
 import math
 import os
+import shutil
 import signal
 import time
 
@@ -5284,6 +5285,95 @@ class AutoTestPlane(vehicle_test_suite.TestSuite):
             self.set_current_waypoint(2)
         self.fly_home_land_and_disarm()
 
+    def lockstep_log_messages(self, path, types):
+        '''return messages of the given types from a log, keyed by type,
+        timestamp and instance'''
+        ret = {}
+        dfreader = self.dfreader_for_path(path)
+        while True:
+            m = dfreader.recv_match(type=types)
+            if m is None:
+                break
+            instance = getattr(m, 'I', getattr(m, 'C', 0))
+            ret[(m.get_type(), m.TimeUS, instance)] = [getattr(m, f) for f in m._fieldnames]
+        return ret
+
+    def LockstepReproducible(self):
+        '''check lock-step runs of the same mission produce the same log'''
+        self.upload_simple_relhome_mission([
+            (mavutil.mavlink.MAV_CMD_NAV_TAKEOFF, 0, 0, 30),
+            (mavutil.mavlink.MAV_CMD_NAV_WAYPOINT, 600, 0, 50),
+            (mavutil.mavlink.MAV_CMD_NAV_WAYPOINT, 600, 600, 50),
+            (mavutil.mavlink.MAV_CMD_NAV_LOITER_UNLIM, 0, 0, 50),
+        ])
+        # the vehicle flies the mission without any input from us, as
+        # our messages reach it at a simulation time which depends on
+        # host load. Terrain is off as its data comes from the GCS
+        self.set_parameters({
+            "ARMING_REQUIRE": 0,
+            "INITIAL_MODE": 10,  # AUTO
+            "SIM_RC_FAIL": 1,  # no pulses
+            "THR_FAILSAFE": 0,
+            "TERRAIN_ENABLE": 0,
+        })
+        self.delay_sim_time(2)  # let the parameters reach storage
+
+        # both runs start from the same storage
+        storage_snapshot = "eeprom-lockstep.bin"
+        self.mav.close()
+        self.stop_SITL()
+        shutil.copy("eeprom.bin", storage_snapshot)
+
+        logs = []
+        for run in range(2):
+            if run > 0:
+                self.mav.close()
+                self.stop_SITL()
+            shutil.copy(storage_snapshot, "eeprom.bin")
+            self.start_SITL(customisations=["--lockstep"], wipe=False)
+            self.mav.do_connect()
+            self.wait_heartbeat(drain_mav=True)
+            self.set_streamrate(self.sitl_streamrate())
+            self.wait_current_waypoint(3, timeout=300)
+            self.delay_sim_time(20)
+            logs.append(self.current_onboard_log_filepath())
+        os.unlink(storage_snapshot)
+
+        # storage was changed behind our back, start again from scratch
+        self.reset_SITL_commandline()
+
+        types = ['ATT', 'POS', 'IMU', 'BARO', 'GPS', 'XKF1', 'CTUN', 'RCOU']
+        first = self.lockstep_log_messages(logs[0], types)
+        second = self.lockstep_log_messages(logs[1], types)
+        if len(first) == 0 or len(second) == 0:
+            raise NotAchievedException("No messages in lock-step logs")
+
+        # the runs were stopped at different times, and either run
+        # may have dropped messages if the logger fell behind
+        end_us = min(max(k[1] for k in first), max(k[1] for k in second))
+        count = 0
+        common = 0
+        mismatches = 0
+        for key, values in first.items():
+            if key[1] > end_us:
+                continue
+            count += 1
+            if key not in second:
+                continue
+            common += 1
+            other = second[key]
+            same = all(a == b or (isinstance(a, float) and math.isnan(a) and math.isnan(b))
+                       for (a, b) in zip(values, other))
+            if not same:
+                mismatches += 1
+                if mismatches <= 10:
+                    self.progress("Mismatch %s: %s != %s" % (str(key), str(values), str(other)))
+        self.progress("Compared %u/%u messages, %u mismatches" % (common, count, mismatches))
+        if mismatches != 0:
+            raise NotAchievedException("Lock-step runs differ (%s, %s)" % (logs[0], logs[1]))
+        if common < 0.9 * count:
+            raise NotAchievedException("Too few messages in both logs (%u/%u)" % (common, count))
+
     def location_from_ADSB_VEHICLE(self, m):
         '''return a mavutil.location extracted from an ADSB_VEHICLE mavlink
         message'''
@@ -5419,6 +5509,7 @@ class AutoTestPlane(vehicle_test_suite.TestSuite):
             self.TerrainRally,
             self.MAV_CMD_NAV_LOITER_UNLIM,
             self.MAV_CMD_NAV_RETURN_TO_LAUNCH,
+            self.LockstepReproducible,
         ])
         return ret
 
@@ -204,15 +204,40 @@ void AP_ADSB::init(void)
         // sanity check param
         in_state.list_size_param.set(constrain_int16(in_state.list_size_param, 1, INT16_MAX));
 
-        in_state.vehicle_list = new adsb_vehicle_t[in_state.list_size_param];
+        const uint16_t list_size = in_state.list_size_param;
 
-        if (in_state.vehicle_list == nullptr) {
+        // size the ICAO table to at least twice the list size to keep
+        // probe sequences short
+        uint32_t icao_table_size = 4;
+        while (icao_table_size < 2U*list_size) {
+            icao_table_size <<= 1;
+        }
+
+        in_state.vehicle_list = new adsb_vehicle_t[list_size];
+        in_state.icao_table = new uint16_t[icao_table_size];
+        in_state.range_heap = new uint16_t[list_size];
+        in_state.range_heap_pos = new uint16_t[list_size];
+        in_state.range = new float[list_size];
+
+        if (in_state.vehicle_list == nullptr ||
+            in_state.icao_table == nullptr ||
+            in_state.range_heap == nullptr ||
+            in_state.range_heap_pos == nullptr ||
+            in_state.range == nullptr) {
             // dynamic RAM allocation of in_state.vehicle_list[] failed
+            delete[] in_state.vehicle_list;
+            delete[] in_state.icao_table;
+            delete[] in_state.range_heap;
+            delete[] in_state.range_heap_pos;
+            delete[] in_state.range;
+            in_state.vehicle_list = nullptr;
             _init_failed = true; // this keeps us from constantly trying to init forever in main update
             GCS_SEND_TEXT(MAV_SEVERITY_INFO, "ADSB: Unable to initialize ADSB vehicle list");
             return;
         }
-        in_state.list_size_allocated = in_state.list_size_param;
+        memset(in_state.icao_table, 0xFF, icao_table_size * sizeof(in_state.icao_table[0]));
+        in_state.icao_table_mask = icao_table_size - 1;
+        in_state.list_size_allocated = list_size;
     }
 
     if (detected_num_instances == 0) {
@@ -438,30 +463,6 @@ void AP_ADSB::update(const AP_ADSB::Loc &loc)
 
 }
 
-/*
- * determine index and distance of furthest vehicle. This is
- * used to bump it off when a new closer aircraft is detected
- */
-void AP_ADSB::determine_furthest_aircraft(void)
-{
-    float max_distance = 0;
-    uint16_t max_distance_index = 0;
-
-    for (uint16_t index = 0; index < in_state.vehicle_count; index++) {
-        if (is_special_vehicle(in_state.vehicle_list[index].info.ICAO_address)) {
-            continue;
-        }
-        const float distance = _my_loc.get_distance(get_location(in_state.vehicle_list[index]));
-        if (max_distance < distance || index == 0) {
-            max_distance = distance;
-            max_distance_index = index;
-        }
-    } // for index
-
-    in_state.furthest_vehicle_index = max_distance_index;
-    in_state.furthest_vehicle_distance = max_distance;
-}
-
 /*
  * Convert/Extract a Location from a vehicle
  */
@@ -487,13 +488,27 @@ void AP_ADSB::delete_vehicle(const uint16_t index)
         return;
     }
 
-    // if the vehicle is the furthest, invalidate it. It has been bumped
-    if (index == in_state.furthest_vehicle_index && in_state.furthest_vehicle_distance > 0) {
-        in_state.furthest_vehicle_distance = 0;
-        in_state.furthest_vehicle_index = 0;
+    const uint16_t last = in_state.vehicle_count-1;
+
+    icao_remove(in_state.vehicle_list[index].info.ICAO_address);
+
+    // take the vehicle out of the range heap by moving the last heap
+    // entry into its place
+    const uint16_t pos = in_state.range_heap_pos[index];
+    if (pos != last) {
+        range_swap(pos, last);
+        range_sift_up(pos);
+        range_sift_down(pos, last);
     }
-    if (index != (in_state.vehicle_count-1)) {
-        in_state.vehicle_list[index] = in_state.vehicle_list[in_state.vehicle_count-1];
+
+    if (index != last) {
+        // move the last vehicle into the gap, keeping the indexes
+        // pointing at it
+        in_state.vehicle_list[index] = in_state.vehicle_list[last];
+        in_state.range[index] = in_state.range[last];
+        in_state.range_heap_pos[index] = in_state.range_heap_pos[last];
+        in_state.range_heap[in_state.range_heap_pos[index]] = index;
+        *icao_find(in_state.vehicle_list[index].info.ICAO_address) = index;
     }
     // TODO: is memset needed? When we decrement the index we essentially forget about it
     memset(&in_state.vehicle_list[in_state.vehicle_count-1], 0, sizeof(adsb_vehicle_t));
@@ -507,13 +522,127 @@ void AP_ADSB::delete_vehicle(const uint16_t index)
  */
 bool AP_ADSB::find_index(const adsb_vehicle_t &vehicle, uint16_t *index) const
 {
-    for (uint16_t i = 0; i < in_state.vehicle_count; i++) {
-        if (in_state.vehicle_list[i].info.ICAO_address == vehicle.info.ICAO_address) {
-            *index = i;
-            return true;
+    const uint16_t *entry = icao_find(vehicle.info.ICAO_address);
+    if (entry == nullptr) {
+        return false;
+    }
+    *index = *entry;
+    return true;
+}
+
+/*
+ * home slot of an ICAO address in the lookup table
+ */
+uint32_t AP_ADSB::icao_slot(const uint32_t icao) const
+{
+    return ((icao * 2654435769U) >> 8) & in_state.icao_table_mask;
+}
+
+/*
+ * return the table entry holding the list index of a vehicle, or
+ * nullptr if the vehicle isn't in the list
+ */
+uint16_t *AP_ADSB::icao_find(const uint32_t icao) const
+{
+    for (uint32_t slot = icao_slot(icao);
+         in_state.icao_table[slot] != UINT16_MAX;
+         slot = (slot + 1) & in_state.icao_table_mask) {
+        if (in_state.vehicle_list[in_state.icao_table[slot]].info.ICAO_address == icao) {
+            return &in_state.icao_table[slot];
         }
     }
-    return false;
+    return nullptr;
+}
+
+/*
+ * add the vehicle at a list index to the lookup table
+ */
+void AP_ADSB::icao_insert(const uint16_t index)
+{
+    uint32_t slot = icao_slot(in_state.vehicle_list[index].info.ICAO_address);
+    while (in_state.icao_table[slot] != UINT16_MAX) {
+        slot = (slot + 1) & in_state.icao_table_mask;
+    }
+    in_state.icao_table[slot] = index;
+}
+
+/*
+ * remove an ICAO address from the lookup table. Later entries of the
+ * probe sequence are shifted back so no tombstones are needed
+ */
+void AP_ADSB::icao_remove(const uint32_t icao)
+{
+    uint16_t *entry = icao_find(icao);
+    if (entry == nullptr) {
+        return;
+    }
+    const uint32_t mask = in_state.icao_table_mask;
+    uint32_t hole = entry - in_state.icao_table;
+    for (uint32_t slot = (hole + 1) & mask;
+         in_state.icao_table[slot] != UINT16_MAX;
+         slot = (slot + 1) & mask) {
+        // an entry can fill the hole if its home slot is not in
+        // (hole, slot], allowing for wrap around
+        const uint32_t home = icao_slot(in_state.vehicle_list[in_state.icao_table[slot]].info.ICAO_address);
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            in_state.icao_table[hole] = in_state.icao_table[slot];
+            hole = slot;
+        }
+    }
+    in_state.icao_table[hole] = UINT16_MAX;
+}
+
+/*
+ * set the range of a vehicle already in the range heap
+ */
+void AP_ADSB::range_update(const uint16_t index, const float range)
+{
+    in_state.range[index] = range;
+    const uint16_t pos = in_state.range_heap_pos[index];
+    range_sift_up(pos);
+    range_sift_down(pos, in_state.vehicle_count);
+}
+
+void AP_ADSB::range_swap(const uint16_t pos1, const uint16_t pos2)
+{
+    const uint16_t index1 = in_state.range_heap[pos1];
+    const uint16_t index2 = in_state.range_heap[pos2];
+    in_state.range_heap[pos1] = index2;
+    in_state.range_heap[pos2] = index1;
+    in_state.range_heap_pos[index2] = pos1;
+    in_state.range_heap_pos[index1] = pos2;
+}
+
+void AP_ADSB::range_sift_up(uint16_t pos)
+{
+    while (pos > 0) {
+        const uint16_t parent = (pos - 1) / 2;
+        if (in_state.range[in_state.range_heap[parent]] >= in_state.range[in_state.range_heap[pos]]) {
+            break;
+        }
+        range_swap(pos, parent);
+        pos = parent;
+    }
+}
+
+void AP_ADSB::range_sift_down(uint16_t pos, const uint16_t count)
+{
+    while (true) {
+        const uint32_t left = 2U*pos + 1;
+        if (left >= count) {
+            break;
+        }
+        uint32_t largest = left;
+        if (left + 1 < count &&
+            in_state.range[in_state.range_heap[left+1]] > in_state.range[in_state.range_heap[left]]) {
+            largest = left + 1;
+        }
+        if (in_state.range[in_state.range_heap[pos]] >= in_state.range[in_state.range_heap[largest]]) {
+            break;
+        }
+        range_swap(pos, largest);
+        pos = largest;
+    }
 }
 
 /*
@@ -553,40 +682,37 @@ void AP_ADSB::handle_adsb_vehicle(const adsb_vehicle_t &vehicle)
         }
         return;
 
-    } else if (is_tracked_in_list) {
+    }
+
+    // range used to pick the vehicle to drop when the list is full
+    const float range = is_special ? -1 : my_loc_distance_to_vehicle;
+
+    if (is_tracked_in_list) {
 
         // found, update it
         set_vehicle(index, vehicle);
+        range_update(index, range);
 
     } else if (in_state.vehicle_count < in_state.list_size_allocated) {
 
         // not found and there's room, add it to the end of the list
-        set_vehicle(in_state.vehicle_count, vehicle);
+        index = in_state.vehicle_count;
+        set_vehicle(index, vehicle);
+        icao_insert(index);
+        in_state.range_heap[index] = index;
+        in_state.range_heap_pos[index] = index;
         in_state.vehicle_count++;
+        range_update(index, range);
 
-    } else {
+    } else if (!my_loc_is_zero) {
         // buffer is full. if new vehicle is closer than furthest, replace furthest with new
-
-        if (my_loc_is_zero) {
-            // nothing else to do
-            in_state.furthest_vehicle_distance = 0;
-            in_state.furthest_vehicle_index = 0;
-
-        } else {
-            if (in_state.furthest_vehicle_distance <= 0) {
-                // ensure this is populated
-                determine_furthest_aircraft();
-            }
-
-            if (my_loc_distance_to_vehicle < in_state.furthest_vehicle_distance) { // is closer than the furthest
-                // replace with the furthest vehicle
-                set_vehicle(in_state.furthest_vehicle_index, vehicle);
-
-                // in_state.furthest_vehicle_index is now invalid because the vehicle was overwritten, need
-                // to run determine_furthest_aircraft() to determine a new one next time
-                in_state.furthest_vehicle_distance = 0;
-                in_state.furthest_vehicle_index = 0;
-            }
+        index = in_state.range_heap[0];
+        const float furthest_range = in_state.range[index];
+        if (furthest_range > 0 && my_loc_distance_to_vehicle < furthest_range) {
+            icao_remove(in_state.vehicle_list[index].info.ICAO_address);
+            set_vehicle(index, vehicle);
+            icao_insert(index);
+            range_update(index, range);
         }
     } // if buffer full
 
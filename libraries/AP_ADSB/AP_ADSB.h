@@ -46,6 +46,7 @@ public:
     friend class AP_ADSB_uAvionix_UCP;
     friend class AP_ADSB_Sagetech;
     friend class AP_ADSB_Sagetech_MXS;
+    friend class AP_ADSB_Test;
 
     // constructor
     AP_ADSB();
@@ -233,9 +234,6 @@ private:
     // check to see if we are initialized (and possibly do initialization)
     bool check_startup();
 
-    // compares current vector against vehicle_list to detect threats
-    void determine_furthest_aircraft(void);
-
     // return index of given vehicle if ICAO_ADDRESS matches. return -1 if no match
     bool find_index(const adsb_vehicle_t &vehicle, uint16_t *index) const;
 
@@ -244,6 +242,19 @@ private:
 
     void set_vehicle(const uint16_t index, const adsb_vehicle_t &vehicle);
 
+    // ICAO address lookup table, open addressing with linear probing
+    uint32_t icao_slot(const uint32_t icao) const;
+    void icao_insert(const uint16_t index);
+    void icao_remove(const uint32_t icao);
+    uint16_t *icao_find(const uint32_t icao) const;
+
+    // max-heap of list indexes ordered by range, used to find the
+    // vehicle to drop when the list is full
+    void range_update(const uint16_t index, const float range);
+    void range_sift_up(uint16_t pos);
+    void range_sift_down(uint16_t pos, const uint16_t count);
+    void range_swap(const uint16_t pos1, const uint16_t pos2);
+
     // Generates pseudorandom ICAO from gps time, lat, and lon
     uint32_t genICAO(const Location &loc) const;
 
@@ -275,9 +286,18 @@ private:
         AP_Int32    list_radius;
         AP_Int16    list_altitude;
 
-        // index of and distance to furthest vehicle in list
-        uint16_t    furthest_vehicle_index;
-        float       furthest_vehicle_distance;
+        // index of vehicle_list by ICAO address. Entries are list
+        // indexes, UINT16_MAX marks an empty slot
+        uint16_t    *icao_table;
+        uint32_t    icao_table_mask;
+
+        // vehicle_list indexes as a max-heap on range, the range of
+        // each vehicle from us when it was last updated and the
+        // position of each vehicle in the heap. Special vehicles have
+        // a negative range so they are never dropped
+        uint16_t    *range_heap;
+        uint16_t    *range_heap_pos;
+        float       *range;
 
         // streamrate stuff
         uint32_t    send_start_ms[MAVLINK_COMM_NUM_BUFFERS];
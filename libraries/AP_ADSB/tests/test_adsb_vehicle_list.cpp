@@ -0,0 +1,257 @@
+/*
+  test the ICAO lookup table and range heap which index the ADSB
+  vehicle list
+ */
+#include <AP_gtest.h>
+
+#include <AP_ADSB/AP_ADSB.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+const struct AP_Param::GroupInfo        GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+GCS_Dummy _gcs;
+
+#if HAL_ADSB_ENABLED
+
+static const Location origin{-353632610, 1491652300, 58400, Location::AltFrame::ABSOLUTE};
+
+class AP_ADSB_Test
+{
+public:
+    AP_ADSB_Test(uint16_t list_size)
+    {
+        // each test gets a fresh singleton
+        AP_ADSB::_singleton = nullptr;
+        adsb = new AP_ADSB();
+        adsb->in_state.list_size_param.set(list_size);
+        adsb->in_state.list_radius.set(0);
+        adsb->_log.set(AP_ADSB::Logging::NONE);
+        adsb->init();
+
+        // no driver is configured so init() gives up after allocating
+        // the list. Pretend one is so vehicles are accepted
+        adsb->_init_failed = false;
+        adsb->_type[0].set(int8_t(AP_ADSB::Type::uAvionix_MAVLink));
+        static_cast<Location &>(adsb->_my_loc) = origin;
+    }
+
+    ~AP_ADSB_Test()
+    {
+        delete adsb;
+    }
+
+    // report a vehicle distance metres north of us
+    void report(uint32_t icao, float distance)
+    {
+        Location loc = origin;
+        loc.offset(distance, 0);
+        AP_ADSB::adsb_vehicle_t vehicle {};
+        vehicle.info.ICAO_address = icao;
+        vehicle.info.lat = loc.lat;
+        vehicle.info.lon = loc.lng;
+        vehicle.info.altitude = loc.alt * 10;
+        vehicle.info.flags = ADSB_FLAGS_VALID_COORDS | ADSB_FLAGS_VALID_ALTITUDE;
+        vehicle.last_update_ms = AP_HAL::millis();
+        adsb->handle_adsb_vehicle(vehicle);
+    }
+
+    void remove(uint32_t icao)
+    {
+        const uint16_t *entry = adsb->icao_find(icao);
+        ASSERT_NE(entry, nullptr);
+        adsb->delete_vehicle(*entry);
+    }
+
+    bool tracked(uint32_t icao) const
+    {
+        return adsb->icao_find(icao) != nullptr;
+    }
+
+    uint16_t count() const
+    {
+        return adsb->in_state.vehicle_count;
+    }
+
+    uint32_t table_size() const
+    {
+        return adsb->in_state.icao_table_mask + 1;
+    }
+
+    // the table slot holding a vehicle
+    int32_t slot(uint32_t icao) const
+    {
+        const uint16_t *entry = adsb->icao_find(icao);
+        if (entry == nullptr) {
+            return -1;
+        }
+        return entry - adsb->in_state.icao_table;
+    }
+
+    // the next ICAO address after icao whose home slot is home
+    uint32_t icao_with_home(uint32_t home, uint32_t icao) const
+    {
+        do {
+            icao++;
+        } while (adsb->icao_slot(icao) != home);
+        return icao;
+    }
+
+    float range(uint32_t icao) const
+    {
+        return adsb->in_state.range[*adsb->icao_find(icao)];
+    }
+
+    uint32_t furthest() const
+    {
+        return adsb->in_state.vehicle_list[adsb->in_state.range_heap[0]].info.ICAO_address;
+    }
+
+    // check both indexes agree with the vehicle list
+    void check_indexes() const
+    {
+        const auto &s = adsb->in_state;
+        uint16_t entries = 0;
+        for (uint32_t i=0; i<table_size(); i++) {
+            if (s.icao_table[i] != UINT16_MAX) {
+                EXPECT_LT(s.icao_table[i], s.vehicle_count);
+                entries++;
+            }
+        }
+        EXPECT_EQ(entries, s.vehicle_count);
+        for (uint16_t i=0; i<s.vehicle_count; i++) {
+            const uint16_t *entry = adsb->icao_find(s.vehicle_list[i].info.ICAO_address);
+            ASSERT_NE(entry, nullptr);
+            EXPECT_EQ(*entry, i);
+            EXPECT_EQ(s.range_heap[s.range_heap_pos[i]], i);
+        }
+        for (uint16_t pos=1; pos<s.vehicle_count; pos++) {
+            EXPECT_GE(s.range[s.range_heap[(pos-1)/2]], s.range[s.range_heap[pos]]);
+        }
+    }
+
+    AP_ADSB *adsb;
+};
+
+TEST(ADSBVehicleList, InsertReplace)
+{
+    AP_ADSB_Test t(8);
+    for (uint32_t i=1; i<=8; i++) {
+        t.report(0x100 + i, 1000 * i);
+        t.check_indexes();
+    }
+    EXPECT_EQ(t.count(), 8);
+    for (uint32_t i=1; i<=8; i++) {
+        EXPECT_TRUE(t.tracked(0x100 + i));
+    }
+    EXPECT_FALSE(t.tracked(0x100));
+    EXPECT_EQ(t.furthest(), 0x108U);
+
+    // a vehicle we already track is updated in place
+    t.report(0x101, 9500);
+    t.check_indexes();
+    EXPECT_EQ(t.count(), 8);
+    EXPECT_NEAR(t.range(0x101), 9500, 1);
+    EXPECT_EQ(t.furthest(), 0x101U);
+
+    t.report(0x101, 500);
+    t.check_indexes();
+    EXPECT_EQ(t.furthest(), 0x108U);
+}
+
+TEST(ADSBVehicleList, DeleteWraparound)
+{
+    // four vehicles get an eight slot table
+    AP_ADSB_Test t(4);
+    ASSERT_EQ(t.table_size(), 8U);
+    const uint32_t last = t.table_size() - 1;
+
+    // a, b and c all hash to the last slot so b and c wrap around to
+    // the start of the table, around g which is in its home slot
+    const uint32_t a = t.icao_with_home(last, 0);
+    const uint32_t b = t.icao_with_home(last, a);
+    const uint32_t g = t.icao_with_home(1, 0);
+    const uint32_t c = t.icao_with_home(last, b);
+    t.report(a, 1000);
+    t.report(b, 2000);
+    t.report(g, 3000);
+    t.report(c, 4000);
+    t.check_indexes();
+    EXPECT_EQ(t.slot(a), int32_t(last));
+    EXPECT_EQ(t.slot(b), 0);
+    EXPECT_EQ(t.slot(g), 1);
+    EXPECT_EQ(t.slot(c), 2);
+
+    // removing a shifts b back across the wrap and c back past g,
+    // while g stays in its home slot
+    t.remove(a);
+    t.check_indexes();
+    EXPECT_FALSE(t.tracked(a));
+    EXPECT_EQ(t.slot(b), int32_t(last));
+    EXPECT_EQ(t.slot(g), 1);
+    EXPECT_EQ(t.slot(c), 0);
+
+    // removing b shifts c back across the wrap
+    t.remove(b);
+    t.check_indexes();
+    EXPECT_EQ(t.slot(c), int32_t(last));
+    EXPECT_EQ(t.slot(g), 1);
+
+    t.remove(c);
+    t.remove(g);
+    t.check_indexes();
+    EXPECT_EQ(t.count(), 0);
+
+    // and the table is usable again
+    t.report(b, 1000);
+    t.check_indexes();
+    EXPECT_EQ(t.slot(b), int32_t(last));
+}
+
+TEST(ADSBVehicleList, EvictFurthest)
+{
+    AP_ADSB_Test t(4);
+    for (uint32_t i=1; i<=4; i++) {
+        t.report(i, 1000 * i);
+    }
+    t.check_indexes();
+
+    // a vehicle further than all we track is ignored
+    t.report(5, 5000);
+    t.check_indexes();
+    EXPECT_FALSE(t.tracked(5));
+    EXPECT_EQ(t.count(), 4);
+
+    // a closer vehicle replaces the furthest
+    t.report(6, 500);
+    t.check_indexes();
+    EXPECT_TRUE(t.tracked(6));
+    EXPECT_FALSE(t.tracked(4));
+    EXPECT_EQ(t.count(), 4);
+
+    // the furthest vehicle follows updates
+    t.report(1, 6000);
+    t.check_indexes();
+    EXPECT_EQ(t.furthest(), 1U);
+    t.report(7, 2500);
+    t.check_indexes();
+    EXPECT_FALSE(t.tracked(1));
+    EXPECT_TRUE(t.tracked(7));
+
+    // the special vehicle is never dropped, however far away it is
+    t.adsb->set_special_ICAO_target(3);
+    t.report(3, 7000);
+    for (uint32_t i=10; i<20; i++) {
+        t.report(i, 100 - i);
+        t.check_indexes();
+        EXPECT_TRUE(t.tracked(i));
+        EXPECT_TRUE(t.tracked(3));
+    }
+    EXPECT_EQ(t.count(), 4);
+}
+
+#endif // HAL_ADSB_ENABLED
+
+AP_GTEST_MAIN()
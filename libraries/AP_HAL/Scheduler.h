@@ -126,6 +126,15 @@ public:
         return false;
     }
 
+    /*
+      pin the calling thread to one CPU. The CPU is the cpu_index'th
+      (modulo count) of the CPUs the process may run on. Returns false
+      if not supported by the HAL
+     */
+    virtual bool set_thread_cpu(uint8_t cpu_index) {
+        return false;
+    }
+
 private:
 
     AP_HAL::Proc _delay_cb;
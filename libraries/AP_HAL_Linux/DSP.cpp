@@ -0,0 +1,264 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <AP_HAL/AP_HAL.h>
+
+#if HAL_WITH_DSP
+
+#include <AP_Math/AP_Math.h>
+#include <GCS_MAVLink/GCS.h>
+#include "DSP.h"
+#include <cmath>
+
+using namespace Linux;
+
+extern const AP_HAL::HAL& hal;
+
+/*
+  The N point real FFT is calculated as an N/2 point complex FFT of the
+  even/odd samples packed as real/imaginary parts, followed by a split
+  step that recovers the N/2+1 real FFT bins. This halves the work of
+  the full complex FFT used in SITL. The data is kept as separate real
+  and imaginary arrays with contiguous per-stage twiddles so that the
+  inner loops are unit stride and are vectorised by the compiler.
+  The output matches the layout of the ChibiOS CMSIS implementation.
+ */
+
+// initialize the FFT state machine
+AP_HAL::DSP::FFTWindowState* DSP::fft_init(uint16_t window_size, uint16_t sample_rate, uint8_t sliding_window_size)
+{
+    // the FFT requires a power of two window
+    if (window_size < 4 || (window_size & (window_size - 1)) != 0) {
+        return nullptr;
+    }
+    DSP::FFTWindowStateLinux* fft = new DSP::FFTWindowStateLinux(window_size, sample_rate, sliding_window_size);
+    if (fft == nullptr || !fft->is_valid() || fft->_hanning_window == nullptr || fft->_rfft_data == nullptr || fft->_freq_bins == nullptr || fft->_derivative_freq_bins == nullptr) {
+        delete fft;
+        return nullptr;
+    }
+    return fft;
+}
+
+// start an FFT analysis
+void DSP::fft_start(AP_HAL::DSP::FFTWindowState* state, FloatBuffer& samples, uint16_t advance)
+{
+    step_hanning((FFTWindowStateLinux*)state, samples, advance);
+}
+
+// perform remaining steps of an FFT analysis
+uint16_t DSP::fft_analyse(AP_HAL::DSP::FFTWindowState* state, uint16_t start_bin, uint16_t end_bin, float noise_att_cutoff)
+{
+    FFTWindowStateLinux* fft = (FFTWindowStateLinux*)state;
+    step_cfft(fft);
+    step_rfft_split(fft);
+    step_cmplx_mag(fft, start_bin, end_bin, noise_att_cutoff);
+    return step_calc_frequencies(fft, start_bin, end_bin);
+}
+
+// create an instance of the FFT state machine
+DSP::FFTWindowStateLinux::FFTWindowStateLinux(uint16_t window_size, uint16_t sample_rate, uint8_t sliding_window_size)
+    : AP_HAL::DSP::FFTWindowState::FFTWindowState(window_size, sample_rate, sliding_window_size)
+{
+    if (_freq_bins == nullptr || _hanning_window == nullptr || _rfft_data == nullptr || _derivative_freq_bins == nullptr) {
+        GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "Failed to allocate window for DSP");
+        return;
+    }
+
+    const uint16_t m = _bin_count;
+
+    _buf_re = new float[m];
+    _buf_im = new float[m];
+    _stage_tw_re = new float[m];
+    _stage_tw_im = new float[m];
+    _split_tw_re = new float[m];
+    _split_tw_im = new float[m];
+    _bitrev = new uint16_t[m];
+
+    // bit reversal permutation of the half-length sequence
+    uint8_t bits = 0;
+    while ((1U << bits) < m) {
+        bits++;
+    }
+    for (uint16_t k = 0; k < m; k++) {
+        uint16_t r = 0;
+        for (uint8_t b = 0; b < bits; b++) {
+            r |= ((k >> b) & 1U) << (bits - 1 - b);
+        }
+        _bitrev[k] = r;
+    }
+
+    // twiddles for each butterfly stage, stage of length len uses
+    // exp(-2*pi*i*j/len) for j < len/2
+    uint16_t ofs = 0;
+    for (uint16_t len = 2; len <= m; len <<= 1) {
+        const uint16_t half = len / 2;
+        for (uint16_t j = 0; j < half; j++) {
+            const double a = -2.0 * M_PI * j / len;
+            _stage_tw_re[ofs + j] = cos(a);
+            _stage_tw_im[ofs + j] = sin(a);
+        }
+        ofs += half;
+    }
+
+    for (uint16_t k = 0; k < m; k++) {
+        const double a = -2.0 * M_PI * k / window_size;
+        _split_tw_re[k] = cos(a);
+        _split_tw_im[k] = sin(a);
+    }
+}
+
+DSP::FFTWindowStateLinux::~FFTWindowStateLinux()
+{
+    delete[] _buf_re;
+    delete[] _buf_im;
+    delete[] _stage_tw_re;
+    delete[] _stage_tw_im;
+    delete[] _split_tw_re;
+    delete[] _split_tw_im;
+    delete[] _bitrev;
+}
+
+// step 1: filter the incoming samples through a Hanning window
+void DSP::step_hanning(FFTWindowStateLinux* fft, FloatBuffer& samples, uint16_t advance)
+{
+    // apply hanning window to gyro samples and store result in _freq_bins
+    // hanning starts and ends with 0, could be skipped for minor speed improvement
+    uint32_t read_window = samples.peek(&fft->_freq_bins[0], fft->_window_size);
+    if (read_window != fft->_window_size) {
+        return;
+    }
+    samples.advance(advance);
+    mult_f32(&fft->_freq_bins[0], &fft->_hanning_window[0], &fft->_freq_bins[0], fft->_window_size);
+}
+
+// step 2: half-length complex FFT of the even/odd packed samples
+void DSP::step_cfft(FFTWindowStateLinux* fft)
+{
+    const uint16_t m = fft->_bin_count;
+    float* __restrict re = fft->_buf_re;
+    float* __restrict im = fft->_buf_im;
+    const float* in = fft->_freq_bins;
+
+    // pack and reorder in one pass
+    for (uint16_t k = 0; k < m; k++) {
+        const uint16_t r = fft->_bitrev[k];
+        re[r] = in[2 * k];
+        im[r] = in[2 * k + 1];
+    }
+
+    // radix-2 butterflies
+    uint16_t ofs = 0;
+    for (uint16_t len = 2; len <= m; len <<= 1) {
+        const uint16_t half = len / 2;
+        const float* __restrict twr = &fft->_stage_tw_re[ofs];
+        const float* __restrict twi = &fft->_stage_tw_im[ofs];
+        for (uint16_t i = 0; i < m; i += len) {
+            float* __restrict ar = &re[i];
+            float* __restrict ai = &im[i];
+            float* __restrict br = &re[i + half];
+            float* __restrict bi = &im[i + half];
+            for (uint16_t j = 0; j < half; j++) {
+                const float tr = twr[j] * br[j] - twi[j] * bi[j];
+                const float ti = twr[j] * bi[j] + twi[j] * br[j];
+                br[j] = ar[j] - tr;
+                bi[j] = ai[j] - ti;
+                ar[j] += tr;
+                ai[j] += ti;
+            }
+        }
+        ofs += half;
+    }
+}
+
+// step 3: recover the real FFT bins and their power from the half-length result
+void DSP::step_rfft_split(FFTWindowStateLinux* fft)
+{
+    const uint16_t m = fft->_bin_count;
+    const float* re = fft->_buf_re;
+    const float* im = fft->_buf_im;
+    const float* __restrict twr = fft->_split_tw_re;
+    const float* __restrict twi = fft->_split_tw_im;
+    float* __restrict out = fft->_rfft_data;
+    float* __restrict power = fft->_freq_bins;
+
+    // DC and Nyquist are real only
+    const float dc = re[0] + im[0];
+    const float nyquist = re[0] - im[0];
+    out[0] = dc;
+    out[1] = 0;
+    out[2 * m] = nyquist;
+    out[2 * m + 1] = 0;
+    power[0] = sq(dc);
+    power[m] = sq(nyquist);
+
+    for (uint16_t k = 1; k < m; k++) {
+        const uint16_t c = m - k;
+        // even and odd sample spectra
+        const float er = 0.5f * (re[k] + re[c]);
+        const float ei = 0.5f * (im[k] - im[c]);
+        const float odr = 0.5f * (im[k] + im[c]);
+        const float odi = -0.5f * (re[k] - re[c]);
+        const float xr = er + twr[k] * odr - twi[k] * odi;
+        const float xi = ei + twr[k] * odi + twi[k] * odr;
+        out[2 * k] = xr;
+        out[2 * k + 1] = xi;
+        power[k] = xr * xr + xi * xi;
+    }
+}
+
+void DSP::mult_f32(const float* v1, const float* v2, float* vout, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++) {
+        vout[i] = v1[i] * v2[i];
+    }
+}
+
+void DSP::vector_max_float(const float* vin, uint16_t len, float* maxValue, uint16_t* maxIndex) const
+{
+    *maxValue = vin[0];
+    *maxIndex = 0;
+    for (uint16_t i = 1; i < len; i++) {
+        if (vin[i] > *maxValue) {
+            *maxValue = vin[i];
+            *maxIndex = i;
+        }
+    }
+}
+
+void DSP::vector_scale_float(const float* vin, float scale, float* vout, uint16_t len) const
+{
+    for (uint16_t i = 0; i < len; i++) {
+        vout[i] = vin[i] * scale;
+    }
+}
+
+void DSP::vector_add_float(const float* vin1, const float* vin2, float* vout, uint16_t len) const
+{
+    for (uint16_t i = 0; i < len; i++) {
+        vout[i] = vin1[i] + vin2[i];
+    }
+}
+
+float DSP::vector_mean_float(const float* vin, uint16_t len) const
+{
+    float mean_value = 0.0f;
+    for (uint16_t i = 0; i < len; i++) {
+        mean_value += vin[i];
+    }
+    mean_value /= len;
+    return mean_value;
+}
+
+#endif
@@ -0,0 +1,72 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "AP_HAL_Linux.h"
+
+#if HAL_WITH_DSP
+
+namespace Linux {
+
+// Linux implementation of FFT analysis, using a real FFT built from a
+// half-length complex FFT on split real/imaginary arrays so the
+// butterflies vectorise on NEON and SSE
+class DSP : public AP_HAL::DSP {
+public:
+    // initialise an FFT instance
+    virtual FFTWindowState* fft_init(uint16_t window_size, uint16_t sample_rate, uint8_t sliding_window_size) override;
+    // start an FFT analysis with an ObjectBuffer
+    virtual void fft_start(FFTWindowState* state, FloatBuffer& samples, uint16_t advance) override;
+    // perform remaining steps of an FFT analysis
+    virtual uint16_t fft_analyse(FFTWindowState* state, uint16_t start_bin, uint16_t end_bin, float noise_att_cutoff) override;
+
+    // Linux FFT state
+    class FFTWindowStateLinux : public AP_HAL::DSP::FFTWindowState {
+        friend class Linux::DSP;
+
+    public:
+        FFTWindowStateLinux(uint16_t window_size, uint16_t sample_rate, uint8_t sliding_window_size);
+        virtual ~FFTWindowStateLinux();
+
+        bool is_valid() const { return _buf_re != nullptr; }
+
+    private:
+        // half-length complex FFT work area
+        float* _buf_re = nullptr;
+        float* _buf_im = nullptr;
+        // per-stage butterfly twiddles, stages stored one after another
+        float* _stage_tw_re = nullptr;
+        float* _stage_tw_im = nullptr;
+        // exp(-2*pi*i*k/N) for splitting the complex result into real FFT bins
+        float* _split_tw_re = nullptr;
+        float* _split_tw_im = nullptr;
+        // bit reversed index for each half-length sample
+        uint16_t* _bitrev = nullptr;
+    };
+
+private:
+    void step_hanning(FFTWindowStateLinux* fft, FloatBuffer& samples, uint16_t advance);
+    void step_cfft(FFTWindowStateLinux* fft);
+    void step_rfft_split(FFTWindowStateLinux* fft);
+    void mult_f32(const float* v1, const float* v2, float* vout, uint16_t len);
+    void vector_max_float(const float* vin, uint16_t len, float* maxValue, uint16_t* maxIndex) const override;
+    void vector_scale_float(const float* vin, float scale, float* vout, uint16_t len) const override;
+    float vector_mean_float(const float* vin, uint16_t len) const override;
+    void vector_add_float(const float* vin1, const float* vin2, float* vout, uint16_t len) const override;
+};
+
+}
+
+#endif
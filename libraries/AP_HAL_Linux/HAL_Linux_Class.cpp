@@ -17,6 +17,7 @@
 #include "AnalogIn_ADS1115.h"
 #include "AnalogIn_IIO.h"
 #include "AnalogIn_Navio2.h"
+#include "DSP.h"
 #include "GPIO.h"
 #include "I2CDevice.h"
 #include "OpticalFlow_Onboard.h"
@@ -252,7 +253,7 @@ static Empty::OpticalFlow opticalFlow;
 #endif
 
 #if HAL_WITH_DSP
-static Empty::DSP dspDriver;
+static DSP dspDriver;
 #endif
 static Empty::Flash flashDriver;
 static Empty::WSPIDeviceManager wspi_mgr_instance;
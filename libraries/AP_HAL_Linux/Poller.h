@@ -98,6 +98,12 @@ public:
      */
     bool register_pollable(Pollable *p, uint32_t events);
 
+    /*
+     * Change the events @p is waiting for. @p must have been registered
+     * with register_pollable().
+     */
+    bool modify_pollable(Pollable *p, uint32_t events);
+
     /*
      * Unregister @p from this Poller so it doesn't generate any more
      * event. Note that this doesn't destroy @p.
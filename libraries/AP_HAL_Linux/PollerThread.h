@@ -70,6 +70,15 @@ public:
                              uint32_t timeout_usec);
     bool adjust_timer(TimerPollable *p, uint32_t timeout_usec);
 
+    /*
+     * Wait for @events on @p from this thread. The callbacks of @p are
+     * called from this thread. @p is not owned by the thread and must
+     * be removed before it is destroyed.
+     */
+    bool add_pollable(Pollable *p, uint32_t events);
+    bool modify_pollable(Pollable *p, uint32_t events);
+    void remove_pollable(const Pollable *p);
+
     void mainloop();
 
     bool stop() override;
@@ -136,6 +136,9 @@ void Scheduler::init()
         t->thread->start(t->name, t->policy, t->prio);
     }
 
+    _uart_poller.set_stack_size(1024 * 1024);
+    _uart_poller.start("ap-uart-poll", SCHED_FIFO, APM_LINUX_UART_PRIORITY);
+
 #if defined(DEBUG_STACK) && DEBUG_STACK
     register_timer_process(FUNCTOR_BIND_MEMBER(&Scheduler::_debug_stack, void));
 #endif
@@ -150,11 +153,13 @@ void Scheduler::_debug_stack()
                 "\ttimer = %zu\n"
                 "\tio    = %zu\n"
                 "\trcin  = %zu\n"
-                "\tuart  = %zu\n",
+                "\tuart  = %zu\n"
+                "\tuartp = %zu\n",
                 _timer_thread.get_stack_usage(),
                 _io_thread.get_stack_usage(),
                 _rcin_thread.get_stack_usage(),
-                _uart_thread.get_stack_usage());
+                _uart_thread.get_stack_usage(),
+                _uart_poller.get_stack_usage());
         _last_stack_debug_msec = now;
     }
 }
@@ -324,6 +329,9 @@ void Scheduler::set_system_initialized()
 
 void Scheduler::reboot(bool hold_in_bootloader)
 {
+    // don't lose storage writes still waiting to be batched
+    Storage::from(hal.storage)->flush();
+
     exit(1);
 }
 
@@ -360,11 +368,13 @@ void Scheduler::teardown()
     _io_thread.stop();
     _rcin_thread.stop();
     _uart_thread.stop();
+    _uart_poller.stop();
 
     _timer_thread.join();
     _io_thread.join();
     _rcin_thread.join();
     _uart_thread.join();
+    _uart_poller.join();
 }
 
 // calculates an integer to be used as the priority for a newly-created thread
@@ -398,6 +408,35 @@ uint8_t Scheduler::calculate_thread_priority(priority_base base, int8_t priority
     return thread_priority;
 }
 
+/*
+  pin the calling thread to the cpu_index'th CPU of the process
+  affinity mask
+ */
+bool Scheduler::set_thread_cpu(uint8_t cpu_index)
+{
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return false;
+    }
+    const int count = CPU_COUNT(&allowed);
+    if (count == 0) {
+        return false;
+    }
+    int n = cpu_index % count;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed)) {
+            continue;
+        }
+        if (n-- == 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+        }
+    }
+    return false;
+}
+
 /*
   create a new thread
 */
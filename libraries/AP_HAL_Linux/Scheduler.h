@@ -4,6 +4,7 @@
 
 #include "AP_HAL_Linux.h"
 
+#include "PollerThread.h"
 #include "Semaphores.h"
 #include "Thread.h"
 
@@ -53,6 +54,11 @@ public:
       create a new thread
      */
     bool thread_create(AP_HAL::MemberProc, const char *name, uint32_t stack_size, priority_base base, int8_t priority) override;
+
+    /*
+      pin the calling thread to one of the CPUs of the process
+     */
+    bool set_thread_cpu(uint8_t cpu_index) override;
     
     /*
       set cpu affinity mask to be applied on initialization - setting it
@@ -60,6 +66,12 @@ public:
      */
     void set_cpu_affinity(const cpu_set_t &cpu_affinity) { _cpu_affinity = cpu_affinity; }
 
+    /*
+      thread serving the serial devices that have a file descriptor
+      to wait on, or nullptr if it could not be started
+     */
+    PollerThread *get_uart_poller() { return _uart_poller.is_started() ? &_uart_poller : nullptr; }
+
 private:
     class SchedulerThread : public PeriodicThread {
     public:
@@ -102,6 +114,7 @@ private:
     SchedulerThread _io_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_io_task, void), *this};
     SchedulerThread _rcin_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_rcin_task, void), *this};
     SchedulerThread _uart_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_uart_task, void), *this};
+    PollerThread _uart_poller;
 
     void _timer_task();
     void _io_task();
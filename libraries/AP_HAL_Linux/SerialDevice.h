@@ -23,4 +23,11 @@ public:
 
     /* Depends on lower level to implement, most devices are fine with defaults */
     virtual void set_parity(int v) { }
+
+    /*
+     * File descriptor signaling when read() or write() can make progress,
+     * or -1 if the device must be polled. It may change after a read(),
+     * e.g. when a TCP client connects or disconnects.
+     */
+    virtual int get_fd() const { return -1; }
 };
@@ -6,9 +6,11 @@
 #include <stdio.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Math/crc.h>
 #include <AP_Vehicle/AP_Vehicle_Type.h>
 
 using namespace Linux;
@@ -21,6 +23,8 @@ using namespace Linux;
 // name the storage file after the sketch so you can use the same board
 // card for ArduCopter and ArduPlane
 #define STORAGE_FILE SKETCHNAME ".stg"
+#define STORAGE_JOURNAL_FILE SKETCHNAME ".stj"
+#define STORAGE_JOURNAL_MAGIC 0x4A535041 // "APSJ"
 
 extern const AP_HAL::HAL& hal;
 
@@ -171,6 +175,11 @@ void Storage::init()
     }
 
     _fd = fd;
+
+#if HAL_LINUX_STORAGE_JOURNAL_ENABLED
+    _journal_open(dpath);
+#endif
+
     _initialised = true;
 }
 
@@ -217,7 +226,76 @@ void Storage::write_block(uint16_t loc, const void *src, size_t n)
 
 void Storage::_timer_tick(void)
 {
-    if (!_initialised || _dirty_mask == 0 || _fd == -1) {
+    if (!_initialised) {
+        return;
+    }
+
+    WITH_SEMAPHORE(_sem);
+
+#if HAL_LINUX_STORAGE_JOURNAL_ENABLED
+    // without a storage file to compact into the journal would grow
+    // without bound, fall back to writing lines directly
+    if (_journal_fd != -1 && _fd != -1) {
+        const uint32_t dirty_mask = _dirty_mask;
+        if (dirty_mask != 0) {
+            // grow the batch until writes settle, so bulk updates
+            // like parameter loads and mission uploads go out as one
+            // record
+            const uint32_t now_ms = AP_HAL::millis();
+            if (dirty_mask != _batch_mask) {
+                if (_batch_mask == 0) {
+                    _batch_start_ms = now_ms;
+                }
+                _batch_mask = dirty_mask;
+                _batch_change_ms = now_ms;
+            }
+            if (now_ms - _batch_change_ms >= LINUX_STORAGE_JOURNAL_SETTLE_MS ||
+                now_ms - _batch_start_ms >= LINUX_STORAGE_JOURNAL_MAX_DELAY_MS) {
+                _journal_write_batch();
+            }
+        } else if (_compact_offset >= 0 || _journal_size >= LINUX_STORAGE_JOURNAL_COMPACT_SIZE) {
+            _journal_compact();
+        }
+        return;
+    }
+#endif
+
+    _write_lines();
+}
+
+/*
+  write out all dirty lines. The batching in _timer_tick() would
+  otherwise lose up to LINUX_STORAGE_JOURNAL_MAX_DELAY_MS of changes
+  on reboot
+ */
+void Storage::flush(void)
+{
+    if (!_initialised) {
+        return;
+    }
+
+    WITH_SEMAPHORE(_sem);
+
+#if HAL_LINUX_STORAGE_JOURNAL_ENABLED
+    if (_journal_fd != -1 && _fd != -1) {
+        if (_dirty_mask != 0) {
+            _journal_write_batch();
+        }
+        return;
+    }
+#endif
+
+    while (_dirty_mask != 0 && _fd != -1) {
+        _write_lines();
+    }
+}
+
+/*
+  write dirty lines directly to the storage file
+ */
+void Storage::_write_lines(void)
+{
+    if (_dirty_mask == 0 || _fd == -1) {
         return;
     }
 
@@ -267,6 +345,195 @@ void Storage::_timer_tick(void)
     }
 }
 
+#if HAL_LINUX_STORAGE_JOURNAL_ENABLED
+/*
+  open the journal and apply any records in it to the buffer
+ */
+void Storage::_journal_open(const char *dpath)
+{
+    const int dfd = open(dpath, O_RDONLY|O_DIRECTORY|O_CLOEXEC);
+    if (dfd == -1) {
+        fprintf(stderr, "Failed to open storage directory: %s (%m)\n", dpath);
+        return;
+    }
+    _journal_fd = openat(dfd, STORAGE_JOURNAL_FILE, O_RDWR|O_CREAT|O_APPEND|O_CLOEXEC, 0666);
+    if (_journal_fd == -1) {
+        fprintf(stderr, "Failed to open storage journal %s/%s (%m)\n", dpath,
+                STORAGE_JOURNAL_FILE);
+    } else {
+        // ensure the directory entry survives a power loss
+        fsync(dfd);
+    }
+    close(dfd);
+
+    if (_journal_fd == -1) {
+        return;
+    }
+    _journal_replay();
+
+    // the journal needs a writable storage file to compact into. The
+    // fallback path in init() opens it read-only
+    const int flags = fcntl(_fd, F_GETFL);
+    if (flags == -1 || (flags & O_ACCMODE) != O_RDWR) {
+        close(_journal_fd);
+        _journal_fd = -1;
+        return;
+    }
+
+    // start each boot with an empty journal, so it can't grow across
+    // boots that don't run long enough to compact it
+    if (_journal_size > 0) {
+        do {
+            _journal_compact();
+        } while (_compact_offset >= 0);
+    }
+}
+
+/*
+  apply journal records in order. Replay stops at the first record
+  that is truncated or fails its checksum, which is where a write was
+  interrupted, and the journal is cut back to the last good record
+ */
+void Storage::_journal_replay(void)
+{
+    const uint32_t all_lines = (LINUX_STORAGE_NUM_LINES >= 32) ? 0xFFFFFFFFU : ((1U<<LINUX_STORAGE_NUM_LINES)-1);
+    uint32_t good_size = 0;
+
+    if (lseek(_journal_fd, 0, SEEK_SET) != 0) {
+        return;
+    }
+    while (true) {
+        struct journal_header hdr;
+        if (read(_journal_fd, &hdr, sizeof(hdr)) != sizeof(hdr) ||
+            hdr.magic != STORAGE_JOURNAL_MAGIC ||
+            hdr.line_mask == 0 ||
+            (hdr.line_mask & ~all_lines) != 0) {
+            break;
+        }
+        const ssize_t len = __builtin_popcount(hdr.line_mask) * LINUX_STORAGE_LINE_SIZE;
+        if (read(_journal_fd, _scratch, len) != len) {
+            break;
+        }
+        uint32_t crc = crc_crc32(0, (const uint8_t *)&hdr.line_mask, sizeof(hdr.line_mask));
+        crc = crc_crc32(crc, _scratch, len);
+        if (crc != hdr.crc) {
+            break;
+        }
+        const uint8_t *data = _scratch;
+        for (uint8_t i=0; i<LINUX_STORAGE_NUM_LINES; i++) {
+            if (hdr.line_mask & (1U<<i)) {
+                memcpy(&_buffer[i<<LINUX_STORAGE_LINE_SHIFT], data, LINUX_STORAGE_LINE_SIZE);
+                data += LINUX_STORAGE_LINE_SIZE;
+            }
+        }
+        good_size += sizeof(hdr) + len;
+    }
+
+    struct stat st;
+    if (fstat(_journal_fd, &st) == 0 && uint32_t(st.st_size) != good_size) {
+        fprintf(stderr, "Storage journal: dropping %u bytes of partial record\n",
+                unsigned(st.st_size - good_size));
+        if (ftruncate(_journal_fd, good_size) != 0) {
+            close(_journal_fd);
+            _journal_fd = -1;
+            return;
+        }
+    }
+    _journal_size = good_size;
+}
+
+/*
+  append all dirty lines to the journal as one record, with a single
+  fsync. On failure the lines stay dirty and the batch is retried on
+  the next tick
+ */
+bool Storage::_journal_write_batch(void)
+{
+    // clear the lines before copying, see _mark_dirty()
+    const uint32_t mask = _dirty_mask;
+    _dirty_mask &= ~mask;
+
+    // a batch overwrites the compaction snapshot, restart it later
+    _compact_offset = -1;
+
+    uint32_t len = 0;
+    for (uint8_t i=0; i<LINUX_STORAGE_NUM_LINES; i++) {
+        if (mask & (1U<<i)) {
+            memcpy(&_scratch[len], &_buffer[i<<LINUX_STORAGE_LINE_SHIFT], LINUX_STORAGE_LINE_SIZE);
+            len += LINUX_STORAGE_LINE_SIZE;
+        }
+    }
+
+    struct journal_header hdr;
+    hdr.magic = STORAGE_JOURNAL_MAGIC;
+    hdr.line_mask = mask;
+    hdr.crc = crc_crc32(0, (const uint8_t *)&hdr.line_mask, sizeof(hdr.line_mask));
+    hdr.crc = crc_crc32(hdr.crc, _scratch, len);
+
+    struct iovec iov[2];
+    iov[0].iov_base = &hdr;
+    iov[0].iov_len = sizeof(hdr);
+    iov[1].iov_base = _scratch;
+    iov[1].iov_len = len;
+
+    if (writev(_journal_fd, iov, 2) != ssize_t(sizeof(hdr) + len) ||
+        fsync(_journal_fd) != 0) {
+        // drop any partial record so later records stay reachable
+        _dirty_mask |= mask;
+        (void)ftruncate(_journal_fd, _journal_size);
+        return false;
+    }
+
+    _journal_size += sizeof(hdr) + len;
+    _batch_mask = 0;
+    return true;
+}
+
+/*
+  copy the buffer into the storage file a chunk per tick, then empty
+  the journal. The journal is only emptied if no record was added
+  while compacting, otherwise a later pass retries. A power loss at
+  any point leaves the journal to be replayed over the storage file
+ */
+void Storage::_journal_compact(void)
+{
+    if (_fd == -1) {
+        return;
+    }
+    if (_compact_offset < 0) {
+        memcpy(_scratch, _buffer, sizeof(_scratch));
+        _compact_offset = 0;
+        _compact_journal_size = _journal_size;
+    }
+    if (_compact_offset < int32_t(sizeof(_scratch))) {
+        uint32_t n = sizeof(_scratch) - _compact_offset;
+        if (n > LINUX_STORAGE_JOURNAL_COMPACT_CHUNK) {
+            n = LINUX_STORAGE_JOURNAL_COMPACT_CHUNK;
+        }
+        if (pwrite(_fd, &_scratch[_compact_offset], n, _compact_offset) != ssize_t(n)) {
+            close(_fd);
+            _fd = -1;
+            _compact_offset = -1;
+            return;
+        }
+        _compact_offset += n;
+        return;
+    }
+
+    _compact_offset = -1;
+    if (fsync(_fd) != 0) {
+        close(_fd);
+        _fd = -1;
+        return;
+    }
+    if (_journal_size == _compact_journal_size &&
+        ftruncate(_journal_fd, 0) == 0 &&
+        fsync(_journal_fd) == 0) {
+        _journal_size = 0;
+    }
+}
+#endif // HAL_LINUX_STORAGE_JOURNAL_ENABLED
+
 /*
   get storage size and ptr
  */
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <AP_HAL/AP_HAL.h>
+#include "Semaphores.h"
 
 #define LINUX_STORAGE_SIZE HAL_STORAGE_SIZE
 #define LINUX_STORAGE_MAX_WRITE 512
@@ -8,6 +9,23 @@
 #define LINUX_STORAGE_LINE_SIZE (1<<LINUX_STORAGE_LINE_SHIFT)
 #define LINUX_STORAGE_NUM_LINES (LINUX_STORAGE_SIZE/LINUX_STORAGE_LINE_SIZE)
 
+/*
+  journaled storage: dirty lines are batched into records appended to
+  a journal file, with one fsync per batch. The journal is replayed
+  over the storage file and compacted into it at startup, and again
+  once it grows past LINUX_STORAGE_JOURNAL_COMPACT_SIZE
+ */
+#ifndef HAL_LINUX_STORAGE_JOURNAL_ENABLED
+#define HAL_LINUX_STORAGE_JOURNAL_ENABLED 0
+#endif
+// a batch is written once no line has been dirtied for SETTLE_MS, or
+// MAX_DELAY_MS after the first line of the batch was dirtied
+#define LINUX_STORAGE_JOURNAL_SETTLE_MS 100
+#define LINUX_STORAGE_JOURNAL_MAX_DELAY_MS 1000
+#define LINUX_STORAGE_JOURNAL_COMPACT_SIZE (4*LINUX_STORAGE_SIZE)
+// bytes of the storage file rewritten per tick while compacting
+#define LINUX_STORAGE_JOURNAL_COMPACT_CHUNK 4096
+
 namespace Linux {
 
 class Storage : public AP_HAL::Storage
@@ -36,14 +54,45 @@ public:
 
     virtual void _timer_tick(void) override;
 
+    // write out all pending changes, called before rebooting
+    void flush(void);
+
 protected:
     void _mark_dirty(uint16_t loc, uint16_t length);
     int _storage_create(const char *dpath);
+    void _write_lines(void);
 
     int _fd;
+    // serialises _timer_tick() with flush()
+    Semaphore _sem;
     volatile bool _initialised;
     volatile uint32_t _dirty_mask;
     uint8_t _buffer[LINUX_STORAGE_SIZE];
+
+#if HAL_LINUX_STORAGE_JOURNAL_ENABLED
+    struct journal_header {
+        uint32_t magic;
+        uint32_t line_mask;
+        uint32_t crc;
+    };
+
+    void _journal_open(const char *dpath);
+    void _journal_replay(void);
+    bool _journal_write_batch(void);
+    void _journal_compact(void);
+
+    int _journal_fd = -1;
+    uint32_t _journal_size;
+    uint32_t _batch_mask;
+    uint32_t _batch_start_ms;
+    uint32_t _batch_change_ms;
+    // compaction progress, -1 when not compacting
+    int32_t _compact_offset = -1;
+    uint32_t _compact_journal_size;
+    // batch records and compaction snapshots are staged here so the
+    // data written can't change underneath its checksum
+    uint8_t _scratch[LINUX_STORAGE_SIZE];
+#endif
 };
 
 }
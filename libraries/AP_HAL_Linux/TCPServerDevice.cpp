@@ -57,6 +57,14 @@ ssize_t TCPServerDevice::read(uint8_t *buf, uint16_t n)
     return ret;
 }
 
+int TCPServerDevice::get_fd() const
+{
+    if (sock != nullptr) {
+        return sock->get_read_fd();
+    }
+    return listener.get_read_fd();
+}
+
 bool TCPServerDevice::open()
 {
     listener.reuseaddress();
@@ -19,6 +19,9 @@ public:
     virtual ssize_t write(const uint8_t *buf, uint16_t n) override;
     virtual ssize_t read(uint8_t *buf, uint16_t n) override;
 
+    /* the client socket once connected, else the listening socket */
+    virtual int get_fd() const override;
+
 private:
     SocketAPM_native listener{false};
     SocketAPM_native *sock = nullptr;
@@ -10,6 +10,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
@@ -20,6 +21,7 @@
 #include <AP_HAL/AP_HAL.h>
 
 #include "ConsoleDevice.h"
+#include "Scheduler.h"
 #include "TCPServerDevice.h"
 #include "UARTDevice.h"
 #include "UDPDevice.h"
@@ -52,6 +54,7 @@ void UARTDriver::set_device_path(const char *path)
 void UARTDriver::_begin(uint32_t b, uint16_t rxS, uint16_t txS)
 {
     if (!_initialised) {
+        _poll_unregister();
         if (device_path == nullptr && _console) {
             _device = new ConsoleDevice();
         } else {
@@ -77,7 +80,7 @@ void UARTDriver::_begin(uint32_t b, uint16_t rxS, uint16_t txS)
     }
     _initialised = false;
 
-    while (_in_timer) hal.scheduler->delay(1);
+    while (_in_timer || _in_poll) hal.scheduler->delay(1);
 
     _device->set_speed(b);
 
@@ -210,10 +213,11 @@ void UARTDriver::_end()
     _initialised = false;
     _connected = false;
 
-    while (_in_timer) {
+    while (_in_timer || _in_poll) {
         hal.scheduler->delay(1);
     }
 
+    _poll_unregister();
     _device->close();
     _deallocate_buffers();
 }
@@ -270,7 +274,11 @@ ssize_t UARTDriver::_read(uint8_t *buffer, uint16_t count)
         return 0;
     }
 
-    return _readbuf.read(buffer, count);
+    const ssize_t ret = _readbuf.read(buffer, count);
+    if (!_rx_armed && _poll_registered) {
+        _poll_arm_rx();
+    }
+    return ret;
 }
 
 bool UARTDriver::_discard_input()
@@ -279,6 +287,9 @@ bool UARTDriver::_discard_input()
         return false;
     }
     _readbuf.clear();
+    if (!_rx_armed && _poll_registered) {
+        _poll_arm_rx();
+    }
     return true;
 }
 
@@ -296,6 +307,10 @@ size_t UARTDriver::_write(const uint8_t *buffer, size_t size)
 
     size_t ret = _writebuf.write(buffer, size);
     _write_mutex.give();
+
+    if (_poll_registered) {
+        _poll_arm_tx();
+    }
     return ret;
 }
 
@@ -376,22 +391,10 @@ bool UARTDriver::_write_pending_bytes(void)
 }
 
 /*
-  push any pending bytes to/from the serial port. This is called at
-  1kHz in the timer thread. Doing it this way reduces the system call
-  overhead in the main task enormously.
+  try to fill the read buffer
  */
-void UARTDriver::_timer_tick(void)
+void UARTDriver::_read_pending_bytes(void)
 {
-    if (!_initialised) return;
-
-    _in_timer = true;
-
-    uint8_t num_send = 10;
-    while (num_send != 0 && _write_pending_bytes()) {
-        num_send--;
-    }
-
-    // try to fill the read buffer
     int ret;
     ByteBuffer::IoVec vec[2];
 
@@ -412,8 +415,221 @@ void UARTDriver::_timer_tick(void)
             break;
         }
     }
+}
+
+/*
+  push any pending bytes to/from the serial port. This is called at
+  100Hz in the UART thread for devices that are not served by the
+  UART poller thread. Doing it this way reduces the system call
+  overhead in the main task enormously.
+ */
+void UARTDriver::_timer_tick(void)
+{
+    if (!_initialised) return;
+
+    if (_poll_registered) {
+        // output waiting for the rest of a MAVLink packet disarms
+        // the poller, retry it at the UART thread rate
+        if (_writebuf.available() > 0) {
+            _poll_arm_tx();
+        }
+        // and in case _read() raced with the poller disarming input
+        if (_readbuf.space() > 0) {
+            _poll_arm_rx();
+        }
+        return;
+    }
+
+    _in_timer = true;
+
+    uint8_t num_send = 10;
+    while (num_send != 0 && _write_pending_bytes()) {
+        num_send--;
+    }
+
+    _read_pending_bytes();
 
     _in_timer = false;
+
+    if (_connected) {
+        _poll_register();
+    }
+}
+
+/*
+  start serving the device from the UART poller thread if it has a
+  file descriptor to wait on. Called from the UART thread
+ */
+void UARTDriver::_poll_register()
+{
+    PollerThread *poller = Scheduler::from(hal.scheduler)->get_uart_poller();
+    const int fd = _device->get_fd();
+    if (poller == nullptr || fd < 0) {
+        return;
+    }
+
+    WITH_SEMAPHORE(_poll_sem);
+
+    if (fd == _poll_failed_fd) {
+        // hung up, keep polling it from the UART thread
+        return;
+    }
+    _poll_failed_fd = -1;
+
+    _pollable.set_fd(fd);
+    _rx_armed = _readbuf.space() > 0;
+    _tx_armed = _writebuf.available() > 0;
+    _poll_registered = true;
+    if (!poller->add_pollable(&_pollable, _poll_events())) {
+        _poll_registered = false;
+        _rx_armed = false;
+        _tx_armed = false;
+        _pollable.set_fd(-1);
+        _poll_failed_fd = fd;
+    }
+}
+
+/*
+  stop serving the device from the UART poller thread
+ */
+void UARTDriver::_poll_unregister()
+{
+    WITH_SEMAPHORE(_poll_sem);
+
+    if (!_poll_registered) {
+        return;
+    }
+
+    PollerThread *poller = Scheduler::from(hal.scheduler)->get_uart_poller();
+    if (poller != nullptr) {
+        poller->remove_pollable(&_pollable);
+    }
+    _poll_registered = false;
+    _rx_armed = false;
+    _tx_armed = false;
+    _pollable.set_fd(-1);
+}
+
+/*
+  epoll events to wait for. Input is not waited for while the read
+  buffer is full, as a level triggered EPOLLIN would fire continuously
+  and starve the main thread
+ */
+uint32_t UARTDriver::_poll_events() const
+{
+    return (_rx_armed ? EPOLLIN : 0) | (_tx_armed ? EPOLLOUT : 0);
+}
+
+/*
+  wait for input again once the read buffer has space
+ */
+void UARTDriver::_poll_arm_rx()
+{
+    WITH_SEMAPHORE(_poll_sem);
+
+    if (!_poll_registered || _rx_armed) {
+        return;
+    }
+
+    PollerThread *poller = Scheduler::from(hal.scheduler)->get_uart_poller();
+    _rx_armed = true;
+    if (poller == nullptr || !poller->modify_pollable(&_pollable, _poll_events())) {
+        _rx_armed = false;
+    }
+}
+
+/*
+  wait for the device to become writable. The poller stays armed
+  until the write buffer is empty
+ */
+void UARTDriver::_poll_arm_tx()
+{
+    WITH_SEMAPHORE(_poll_sem);
+
+    if (!_poll_registered || _tx_armed) {
+        return;
+    }
+
+    PollerThread *poller = Scheduler::from(hal.scheduler)->get_uart_poller();
+    _tx_armed = true;
+    if (poller == nullptr || !poller->modify_pollable(&_pollable, _poll_events())) {
+        _tx_armed = false;
+    }
+}
+
+void UARTDriver::_poll_can_read()
+{
+    _in_poll = true;
+
+    // ignore events for a descriptor the device no longer uses
+    if (_initialised && _poll_registered && _device->get_fd() == _pollable.get_fd()) {
+        _read_pending_bytes();
+
+        if (_readbuf.space() == 0) {
+            // stop waiting for input until _read() makes space
+            WITH_SEMAPHORE(_poll_sem);
+            PollerThread *poller = Scheduler::from(hal.scheduler)->get_uart_poller();
+            if (_rx_armed && _readbuf.space() == 0) {
+                _rx_armed = false;
+                if (poller == nullptr || !poller->modify_pollable(&_pollable, _poll_events())) {
+                    _rx_armed = true;
+                }
+            }
+        }
+
+        if (_device->get_fd() != _pollable.get_fd()) {
+            // a TCP client connected or went away, the UART thread
+            // registers the new descriptor
+            _poll_unregister();
+        }
+    }
+
+    _in_poll = false;
+}
+
+void UARTDriver::_poll_can_write()
+{
+    _in_poll = true;
+
+    if (_initialised && _poll_registered && _device->get_fd() == _pollable.get_fd()) {
+        bool progress = false;
+        uint8_t num_send = 10;
+        while (num_send != 0 && _write_pending_bytes()) {
+            progress = true;
+            num_send--;
+        }
+
+        WITH_SEMAPHORE(_poll_sem);
+
+        // stop waiting for writability once there is nothing left to
+        // send, or when the rest is a partial packet; _write() re-arms
+        if (_tx_armed && (_writebuf.available() == 0 || !progress)) {
+            PollerThread *poller = Scheduler::from(hal.scheduler)->get_uart_poller();
+            _tx_armed = false;
+            if (poller == nullptr || !poller->modify_pollable(&_pollable, _poll_events())) {
+                _tx_armed = true;
+            }
+        }
+    }
+
+    _in_poll = false;
+}
+
+void UARTDriver::_poll_hang_up()
+{
+    _in_poll = true;
+
+    if (_poll_registered && _device->get_fd() == _pollable.get_fd()) {
+        // a hung up descriptor keeps waking the poller, fall back to
+        // serving it from the UART thread
+        {
+            WITH_SEMAPHORE(_poll_sem);
+            _poll_failed_fd = _pollable.get_fd();
+        }
+        _poll_unregister();
+    }
+
+    _in_poll = false;
 }
 
 void UARTDriver::configure_parity(uint8_t v) {
@@ -4,6 +4,7 @@
 #include <AP_HAL/utility/RingBuffer.h>
 
 #include "AP_HAL_Linux.h"
+#include "Poller.h"
 #include "SerialDevice.h"
 #include "Semaphores.h"
 
@@ -76,6 +77,45 @@ private:
     uint64_t _receive_timestamp[2];
     uint8_t _receive_timestamp_idx;
 
+    /*
+      devices with a file descriptor are served from the scheduler's
+      UART poller thread when readable or, while there is pending
+      output, writable. The others are served by _timer_tick()
+     */
+    class DevicePollable : public Pollable {
+    public:
+        DevicePollable(UARTDriver &uart) : _uart(uart) { }
+        ~DevicePollable() { _fd = -1; }
+
+        void set_fd(int fd) { _fd = fd; }
+
+        void on_can_read() override { _uart._poll_can_read(); }
+        void on_can_write() override { _uart._poll_can_write(); }
+        void on_error() override { _uart._poll_can_read(); }
+        void on_hang_up() override { _uart._poll_hang_up(); }
+
+    private:
+        UARTDriver &_uart;
+    };
+
+    DevicePollable _pollable{*this};
+    Linux::Semaphore _poll_sem;
+    volatile bool _poll_registered;
+    volatile bool _in_poll;
+    volatile bool _rx_armed;
+    bool _tx_armed;
+    int _poll_failed_fd = -1;
+
+    void _poll_register();
+    void _poll_unregister();
+    void _poll_arm_rx();
+    void _poll_arm_tx();
+    uint32_t _poll_events() const;
+    void _poll_can_read();
+    void _poll_can_write();
+    void _poll_hang_up();
+    void _read_pending_bytes();
+
 protected:
     const char *device_path;
     volatile bool _initialised;
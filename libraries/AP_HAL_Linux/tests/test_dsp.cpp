@@ -0,0 +1,96 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#if HAL_WITH_DSP
+
+#include <AP_HAL_Linux/DSP.h>
+#include <AP_Math/AP_Math.h>
+
+static const uint16_t window_size = 64;
+static const uint16_t sample_rate = 1000;
+
+/*
+  run one FFT of a sine wave of the given amplitude centred on a bin
+ */
+static AP_HAL::DSP::FFTWindowState *run_fft(Linux::DSP &dsp, uint16_t bin, float amplitude)
+{
+    AP_HAL::DSP::FFTWindowState *fft = dsp.fft_init(window_size, sample_rate, 0);
+    if (fft == nullptr) {
+        return nullptr;
+    }
+    FloatBuffer samples{window_size};
+    for (uint16_t i = 0; i < window_size; i++) {
+        samples.push(amplitude * sinf(2 * M_PI * bin * i / window_size));
+    }
+    dsp.fft_start(fft, samples, window_size);
+    dsp.fft_analyse(fft, 1, fft->_bin_count, 0.5f);
+    return fft;
+}
+
+TEST(LinuxDSP, tone_bin_and_amplitude)
+{
+    Linux::DSP dsp;
+    const uint16_t bin = 8;
+    const float amplitude = 3.0f;
+
+    AP_HAL::DSP::FFTWindowState *fft = run_fft(dsp, bin, amplitude);
+    ASSERT_NE(fft, nullptr);
+
+    EXPECT_EQ(fft->_peak_data[AP_HAL::DSP::CENTER]._bin, bin);
+    EXPECT_NEAR(fft->_peak_data[AP_HAL::DSP::CENTER]._freq_hz, bin * fft->_bin_resolution, 0.5f * fft->_bin_resolution);
+
+    // the scaled power of a windowed tone centred on a bin is A^2/2
+    EXPECT_NEAR(sqrtf(2 * fft->_freq_bins[bin]), amplitude, 0.05f * amplitude);
+    // and leakage is confined to the neighbouring bins of the window
+    for (uint16_t k = 0; k < fft->_bin_count; k++) {
+        if (k + 1 < bin || k > bin + 1) {
+            EXPECT_LT(fft->_freq_bins[k], 1e-3f * fft->_freq_bins[bin]);
+        }
+    }
+
+    delete fft;
+}
+
+TEST(LinuxDSP, matches_direct_dft)
+{
+    Linux::DSP dsp;
+    const uint16_t bin = 5;
+
+    AP_HAL::DSP::FFTWindowState *fft = run_fft(dsp, bin, 1.0f);
+    ASSERT_NE(fft, nullptr);
+
+    // compare the packed complex bins with a direct DFT of the windowed tone
+    for (uint16_t k = 0; k <= fft->_bin_count; k++) {
+        double re = 0, im = 0;
+        for (uint16_t i = 0; i < window_size; i++) {
+            const double x = fft->_hanning_window[i] * sin(2 * M_PI * bin * i / window_size);
+            re += x * cos(2 * M_PI * k * i / window_size);
+            im -= x * sin(2 * M_PI * k * i / window_size);
+        }
+        EXPECT_NEAR(fft->_rfft_data[2 * k], re, 1e-3);
+        EXPECT_NEAR(fft->_rfft_data[2 * k + 1], im, 1e-3);
+    }
+
+    delete fft;
+}
+
+#endif // HAL_WITH_DSP
+
+AP_GTEST_MAIN()
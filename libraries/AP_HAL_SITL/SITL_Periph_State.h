@@ -55,6 +55,11 @@ public:
     bool use_rtscts(void) const {
         return _use_rtscts;
     }
+
+    // peripherals don't support lock-step mode
+    bool lockstep(void) const {
+        return false;
+    }
     
     uint16_t base_port(void) const {
         return _base_port;
@@ -206,6 +206,12 @@ void SITL_State::wait_clock(uint64_t wait_time_usec)
                 }
             }
 #endif
+            if (_lockstep) {
+                // sleep until the main thread moves the simulation
+                // clock on, rather than polling it against wall time
+                _scheduler->wait_stopped_clock(wait_time_usec);
+                continue;
+            }
             usleep(1000);
         }
     }
@@ -213,7 +219,7 @@ void SITL_State::wait_clock(uint64_t wait_time_usec)
     // MAVProxy/pymavlink take too long to process packets and it ends
     // up seeing traffic well into our past and hits time-out
     // conditions.
-    if (speedup > 1 && hal.scheduler->in_main_thread()) {
+    if ((speedup > 1 || _lockstep) && hal.scheduler->in_main_thread()) {
         while (true) {
             const int queue_length = ((HALSITL::UARTDriver*)hal.serial(0))->get_system_outqueue_length();
             // ::fprintf(stderr, "queue_length=%d\n", (signed)queue_length);
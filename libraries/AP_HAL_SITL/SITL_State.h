@@ -27,6 +27,14 @@ public:
     bool use_rtscts(void) const {
         return _use_rtscts;
     }
+
+    // true when physics and firmware run in lock-step without
+    // wall clock pacing. The main thread never waits for worker
+    // threads, so runs are only reproducible when no worker thread
+    // (scripting, object avoidance) feeds state into the vehicle
+    bool lockstep(void) const {
+        return _lockstep;
+    }
     
     // paths for UART devices
     const char *_serial_path[9] {
@@ -92,6 +100,7 @@ private:
     uint16_t _irlock_port;
 
     bool _synthetic_clock_mode;
+    bool _lockstep;
 
     bool _use_rtscts;
     bool _use_fg_view;
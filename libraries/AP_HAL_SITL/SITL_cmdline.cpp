@@ -72,6 +72,9 @@ static void _sig_segv(int signum)
     abort();
 }
 
+// default start time in lock-step mode, 2020-01-01 00:00:00 UTC
+#define LOCKSTEP_START_TIME_UTC 1577836800
+
 void SITL_State::_usage(void)
 {
     printf("Options:\n"
@@ -122,6 +125,11 @@ void SITL_State::_usage(void)
            "\t--start-time TIMESTR     set simulation start time in UNIX timestamp\n"
            "\t--sysid ID               set SYSID_THISMAV\n"
            "\t--slave number           set the number of JSON slaves\n"
+           "\t--lockstep               run physics in lock-step with the firmware as fast as possible.\n"
+           "\t                         Runs are NOT reproducible if a worker thread feeds state into\n"
+           "\t                         the vehicle, such as scripting or object avoidance, as worker\n"
+           "\t                         threads are scheduled by the host. The main loop, timer and IO\n"
+           "\t                         processes follow simulated time\n"
         );
 }
 
@@ -209,6 +217,7 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
     float sim_rate_hz = 0;
     _instance = 0;
     _synthetic_clock_mode = false;
+    _lockstep = false;
     // default to CMAC
     const char *home_str = nullptr;
     const char *model_str = nullptr;
@@ -239,6 +248,7 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
     static struct timeval first_tv;
     gettimeofday(&first_tv, nullptr);
     time_t start_time_UTC = first_tv.tv_sec;
+    bool start_time_set = false;
     const bool is_replay = APM_BUILD_TYPE(APM_BUILD_Replay);
 
     enum long_options {
@@ -276,6 +286,7 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         CMDLINE_START_TIME,
         CMDLINE_SYSID,
         CMDLINE_SLAVE,
+        CMDLINE_LOCKSTEP,
 #if STORAGE_USE_FLASH
         CMDLINE_SET_STORAGE_FLASH_ENABLED,
 #endif
@@ -335,6 +346,7 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         {"start-time",      true,   0, CMDLINE_START_TIME},
         {"sysid",           true,   0, CMDLINE_SYSID},
         {"slave",           true,   0, CMDLINE_SLAVE},
+        {"lockstep",        false,  0, CMDLINE_LOCKSTEP},
 #if STORAGE_USE_FLASH
         {"set-storage-flash-enabled", true,   0, CMDLINE_SET_STORAGE_FLASH_ENABLED},
 #endif
@@ -505,6 +517,10 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
             break;
         case CMDLINE_START_TIME:
             start_time_UTC = atoi(gopt.optarg);
+            start_time_set = true;
+            break;
+        case CMDLINE_LOCKSTEP:
+            _lockstep = true;
             break;
         case CMDLINE_SYSID: {
             const int32_t sysid = atoi(gopt.optarg);
@@ -581,6 +597,7 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
             }
             sitl_model->set_interface_ports(simulator_address, simulator_port_in, simulator_port_out);
             sitl_model->set_speedup(speedup);
+            sitl_model->set_lockstep(_lockstep);
             sitl_model->set_instance(_instance);
             sitl_model->set_autotest_dir(autotest_dir);
             sitl_model->set_config(config);
@@ -599,6 +616,13 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         exit(1);
     }
 
+    if (_lockstep && !start_time_set) {
+        // the wall clock must not leak into a lock-step run, so that
+        // the same inputs give the same results
+        start_time_UTC = LOCKSTEP_START_TIME_UTC;
+        printf("Lock-step: using start time %lu\n", (unsigned long)start_time_UTC);
+    }
+
     if (AP::sitl()) {
         // Set SITL start time.
         AP::sitl()->start_time_UTC = start_time_UTC;
@@ -295,13 +295,41 @@ void Scheduler::_run_io_procs()
  */
 void Scheduler::stop_clock(uint64_t time_usec)
 {
-    _stopped_clock_usec = time_usec;
+    if (_sitlState->lockstep()) {
+        pthread_mutex_lock(&_clock_mutex);
+        _stopped_clock_usec = time_usec;
+        pthread_cond_broadcast(&_clock_cond);
+        pthread_mutex_unlock(&_clock_mutex);
+    } else {
+        _stopped_clock_usec = time_usec;
+    }
     if (time_usec - _last_io_run > 10000) {
         _last_io_run = time_usec;
         _run_io_procs();
     }
 }
 
+/*
+  wait for the main thread to move the simulation clock to time_usec.
+  The wait is bounded so a thread still notices _should_exit, and time
+  moving on before the clock is stopped for the first time
+ */
+void Scheduler::wait_stopped_clock(uint64_t time_usec)
+{
+    pthread_mutex_lock(&_clock_mutex);
+    if (_stopped_clock_usec < time_usec && !_should_exit) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += 10000000;
+        if (ts.tv_nsec >= 1000000000L) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&_clock_cond, &_clock_mutex, &ts);
+    }
+    pthread_mutex_unlock(&_clock_mutex);
+}
+
 /*
   trampoline for thread create
 */
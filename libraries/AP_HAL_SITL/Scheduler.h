@@ -49,6 +49,10 @@ public:
 
     uint64_t stopped_clock_usec() const { return _stopped_clock_usec; }
 
+    // block a non-main thread until the simulation clock reaches
+    // time_usec. Only used in lock-step mode
+    void wait_stopped_clock(uint64_t time_usec);
+
     static void _run_io_procs();
     static bool _should_exit;
 
@@ -96,6 +100,8 @@ private:
     
     bool _initialized;
     uint64_t _stopped_clock_usec;
+    pthread_mutex_t _clock_mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t _clock_cond = PTHREAD_COND_INITIALIZER;
     uint64_t _last_io_run;
     pthread_t _main_ctx;
 
@@ -120,12 +120,10 @@ void AP_IOMCU_FW::rcin_serial_update(void)
         // don't mix two 115200 uarts
         if (sd3_config == 0) {
             rc_stats.num_dsm_bytes += n;
-            for (uint8_t i=0; i<n; i++) {
-                if (rc.process_byte(b[i], 115200)) {
-                    rc_stats.last_good_ms = now;
-                    if (!rc.should_search(now)) {
-                        rc_state = RC_DSM_PORT;
-                    }
+            if (rc.process_bytes(b, n, 115200)) {
+                rc_stats.last_good_ms = now;
+                if (!rc.should_search(now)) {
+                    rc_state = RC_DSM_PORT;
                 }
             }
         }
@@ -142,12 +140,10 @@ void AP_IOMCU_FW::rcin_serial_update(void)
         } else {
             n = MIN(n, sizeof(b));
             rc_stats.num_sbus_bytes += n;
-            for (uint8_t i=0; i<n; i++) {
-                if (rc.process_byte(b[i], sd3_config==0?100000:115200)) {
-                    rc_stats.last_good_ms = now;
-                    if (!rc.should_search(now)) {
-                        rc_state = RC_SBUS_PORT;
-                    }
+            if (rc.process_bytes(b, n, sd3_config==0?100000:115200)) {
+                rc_stats.last_good_ms = now;
+                if (!rc.should_search(now)) {
+                    rc_state = RC_SBUS_PORT;
                 }
             }
         }
@@ -13,6 +13,12 @@
 
 #define SENSOR_RATE_DEBUG 0
 
+// largest block of gyro samples filtered in one pass, bounding the
+// stack used by _notify_new_gyro_raw_samples()
+#ifndef AP_INERTIALSENSOR_GYRO_BLOCK_MAX
+#define AP_INERTIALSENSOR_GYRO_BLOCK_MAX 16
+#endif
+
 #ifndef AP_HEATER_IMU_INSTANCE
 #define AP_HEATER_IMU_INSTANCE 0
 #endif
@@ -159,6 +165,47 @@ void AP_InertialSensor_Backend::_rotate_and_correct_gyro(uint8_t instance, Vecto
     gyro.rotate(_imu._board_orientation);
 }
 
+/*
+  rotate and correct a block of gyro samples. The temperature
+  correction and offset are worked out once and applied to the whole
+  block
+ */
+void AP_InertialSensor_Backend::_rotate_and_correct_gyro(uint8_t instance, Vector3f *gyro, uint8_t n)
+{
+    // rotate for sensor orientation
+    const enum Rotation orientation = _imu._gyro_orientation[instance];
+    for (uint8_t i = 0; i < n; i++) {
+        gyro[i].rotate(orientation);
+    }
+
+#if HAL_INS_TEMPERATURE_CAL_ENABLE
+    if (_imu.tcal_learning) {
+        for (uint8_t i = 0; i < n; i++) {
+            _imu.tcal(instance).update_gyro_learning(gyro[i], _imu.get_temperature(instance));
+        }
+    }
+#endif
+
+    if (!_imu._calibrating_gyro) {
+        Vector3f correction;
+#if HAL_INS_TEMPERATURE_CAL_ENABLE
+        // apply temperature corrections
+        _imu.tcal(instance).correct_gyro(_imu.get_temperature(instance), _imu.caltemp_gyro(instance), correction);
+#endif
+
+        // gyro calibration is always assumed to have been done in sensor frame
+        correction -= _imu._gyro_offset(instance);
+        for (uint8_t i = 0; i < n; i++) {
+            gyro[i] += correction;
+        }
+    }
+
+    const enum Rotation board_orientation = _imu._board_orientation;
+    for (uint8_t i = 0; i < n; i++) {
+        gyro[i].rotate(board_orientation);
+    }
+}
+
 /*
   rotate gyro vector and add the gyro offset
  */
@@ -255,6 +302,70 @@ void AP_InertialSensor_Backend::apply_gyro_filters(const uint8_t instance, const
     }
 }
 
+/*
+  apply harmonic notch and low pass gyro filters to a block of
+  samples. Each filter runs over the whole block before the next,
+  which gives the same output as apply_gyro_filters() on each sample
+  in turn, apart from a failed filter only being reset at the end of
+  the block
+ */
+void AP_InertialSensor_Backend::apply_gyro_filters(const uint8_t instance, const Vector3f *gyro, Vector3f *filtered, uint8_t n)
+{
+    uint8_t filter_phase = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        save_gyro_window(instance, gyro[i], filter_phase);
+        filtered[i] = gyro[i];
+    }
+    filter_phase++;
+
+    // apply the harmonic notch filters
+    for (auto &notch : _imu.harmonic_notches) {
+        if (!notch.params.enabled()) {
+            continue;
+        }
+        bool inactive = notch.is_inactive();
+#if AP_AHRS_ENABLED
+        if (!notch.params.hasOption(HarmonicNotchFilterParams::Options::EnableOnAllIMUs) &&
+            instance != AP::ahrs().get_primary_gyro_index()) {
+            inactive = true;
+        }
+#endif
+        if (inactive) {
+            notch.filter[instance].reset();
+        } else {
+            notch.filter[instance].apply(filtered, n);
+        }
+        for (uint8_t i = 0; i < n; i++) {
+            save_gyro_window(instance, filtered[i], filter_phase);
+        }
+        filter_phase++;
+    }
+
+    // apply the low pass filter last to attenuate any notch induced noise
+    _imu._gyro_filter[instance].apply(filtered, n);
+
+    // once a filter fails all later samples in the block fail too, so
+    // they keep the last good value and the filters are reset
+    bool failed = false;
+    for (uint8_t i = 0; i < n; i++) {
+        if (filtered[i].is_nan() || filtered[i].is_inf()) {
+            filtered[i] = _imu._gyro_filtered[instance];
+            failed = true;
+        } else {
+            _imu._gyro_filtered[instance] = filtered[i];
+        }
+    }
+    if (failed) {
+        _imu._gyro_filter[instance].reset();
+#if HAL_GYROFFT_ENABLED
+        _imu._post_filter_gyro_filter[instance].reset();
+#endif
+        for (auto &notch : _imu.harmonic_notches) {
+            notch.filter[instance].reset();
+        }
+    }
+}
+
 void AP_InertialSensor_Backend::_notify_new_gyro_raw_sample(uint8_t instance,
                                                             const Vector3f &gyro,
                                                             uint64_t sample_us)
@@ -347,6 +458,98 @@ void AP_InertialSensor_Backend::_notify_new_gyro_raw_sample(uint8_t instance,
     log_gyro_raw(instance, sample_us, gyro, _imu._gyro_filtered[instance]);
 }
 
+/*
+  handle a block of n consecutive samples from a FIFO based sensor. The
+  samples must be rotated and corrected as for
+  _notify_new_gyro_raw_sample()
+ */
+void AP_InertialSensor_Backend::_notify_new_gyro_raw_samples(uint8_t instance, const Vector3f *gyro, uint8_t n)
+{
+    if ((1U<<instance) & _imu.imu_kill_mask) {
+        return;
+    }
+    while (n > AP_INERTIALSENSOR_GYRO_BLOCK_MAX) {
+        _notify_new_gyro_raw_samples(instance, gyro, AP_INERTIALSENSOR_GYRO_BLOCK_MAX);
+        gyro += AP_INERTIALSENSOR_GYRO_BLOCK_MAX;
+        n -= AP_INERTIALSENSOR_GYRO_BLOCK_MAX;
+    }
+    if (n == 0) {
+        return;
+    }
+
+    // count the whole block towards the observed sensor rate
+    _imu._sample_gyro_count[instance] += n - 1;
+    _update_sensor_rate(_imu._sample_gyro_count[instance], _imu._sample_gyro_start_us[instance],
+                        _imu._gyro_raw_sample_rates[instance]);
+
+    uint64_t last_sample_us = _imu._gyro_last_sample_us[instance];
+
+    // don't accept below 40Hz
+    if (_imu._gyro_raw_sample_rates[instance] < 40) {
+        return;
+    }
+
+    const float dt = 1.0f / _imu._gyro_raw_sample_rates[instance];
+    _imu._gyro_last_sample_us[instance] = AP_HAL::micros64();
+    const uint64_t sample_us = _imu._gyro_last_sample_us[instance];
+
+    for (uint8_t i = 0; i < n; i++) {
+#if AP_MODULE_SUPPORTED
+        // call gyro_sample hook if any
+        AP_Module::call_hook_gyro_sample(instance, dt, gyro[i]);
+#endif
+
+        // push gyros if optical flow present
+        if (hal.opticalflow) {
+            hal.opticalflow->push_gyro(gyro[i].x, gyro[i].y, dt);
+        }
+    }
+
+    Vector3f filtered[AP_INERTIALSENSOR_GYRO_BLOCK_MAX];
+    {
+        WITH_SEMAPHORE(_sem);
+        uint64_t now = AP_HAL::micros64();
+
+        for (uint8_t i = 0; i < n; i++) {
+            float sample_dt = dt;
+
+            // compute delta angle and coning correction as for a
+            // single sample
+            Vector3f delta_angle = (gyro[i] + _imu._last_raw_gyro[instance]) * 0.5f * sample_dt;
+            Vector3f delta_coning = (_imu._delta_angle_acc[instance] +
+                                     _imu._last_delta_angle[instance] * (1.0f / 6.0f));
+            delta_coning = delta_coning % delta_angle;
+            delta_coning *= 0.5f;
+
+            if (i == 0 && now - last_sample_us > 100000U) {
+                // zero accumulator if sensor was unhealthy for 0.1s
+                _imu._delta_angle_acc[instance].zero();
+                _imu._delta_angle_acc_dt[instance] = 0;
+                sample_dt = 0;
+                delta_angle.zero();
+            }
+
+            _imu._delta_angle_acc[instance] += delta_angle + delta_coning;
+            _imu._delta_angle_acc_dt[instance] += sample_dt;
+
+            // save previous delta angle for coning correction
+            _imu._last_delta_angle[instance] = delta_angle;
+            _imu._last_raw_gyro[instance] = gyro[i];
+        }
+
+        // apply gyro filters and sample for FFT
+        apply_gyro_filters(instance, gyro, filtered, n);
+
+        _imu._new_gyro_data[instance] = true;
+    }
+
+    // sample_us is the time of the newest sample, step back by dt for
+    // each older sample in the block
+    for (uint8_t i = 0; i < n; i++) {
+        log_gyro_raw(instance, sample_us - uint64_t((n - 1 - i) * dt * 1.0e6f), gyro[i], filtered[i]);
+    }
+}
+
 /*
   handle a delta-angle sample from the backend. This assumes FIFO
   style sampling and the sample should not be rotated or corrected for
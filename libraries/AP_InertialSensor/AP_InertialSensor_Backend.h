@@ -143,12 +143,16 @@ protected:
 
     void _rotate_and_correct_accel(uint8_t instance, Vector3f &accel) __RAMFUNC__;
     void _rotate_and_correct_gyro(uint8_t instance, Vector3f &gyro) __RAMFUNC__;
+    // rotate and correct a block of gyro samples taken at the same temperature
+    void _rotate_and_correct_gyro(uint8_t instance, Vector3f *gyro, uint8_t n) __RAMFUNC__;
 
     // rotate gyro vector, offset and publish
     void _publish_gyro(uint8_t instance, const Vector3f &gyro) __RAMFUNC__; /* front end */
 
     // apply notch and lowpass gyro filters and sample for FFT
     void apply_gyro_filters(const uint8_t instance, const Vector3f &gyro);
+    // apply the same filters to a block of consecutive samples
+    void apply_gyro_filters(const uint8_t instance, const Vector3f *gyro, Vector3f *filtered, uint8_t n);
     void save_gyro_window(const uint8_t instance, const Vector3f &gyro, uint8_t phase);
 
     // this should be called every time a new gyro raw sample is
@@ -159,6 +163,11 @@ protected:
     // sensors, and should be set to zero for FIFO based sensors
     void _notify_new_gyro_raw_sample(uint8_t instance, const Vector3f &accel, uint64_t sample_us=0) __RAMFUNC__;
 
+    // block interface for FIFO based sensors, equivalent to calling
+    // _notify_new_gyro_raw_sample() for each of n consecutive samples
+    // but running the filters over the whole block at once
+    void _notify_new_gyro_raw_samples(uint8_t instance, const Vector3f *gyro, uint8_t n) __RAMFUNC__;
+
     // alternative interface using delta-angles. Rotation and correction is handled inside this function
     void _notify_new_delta_angle(uint8_t instance, const Vector3f &dangle);
     
@@ -405,11 +405,21 @@ void AP_InertialSensor_Invensensev3::accumulate()
     // nothing to do
 }
 
+/*
+  decode a block of FIFO samples straight from the DMA buffer. Accel
+  samples are passed on one at a time, while the gyro samples are
+  converted into a block and handed to the backend together so the
+  filters run once per block
+ */
 bool AP_InertialSensor_Invensensev3::accumulate_samples(const FIFOData *data, uint8_t n_samples)
 {
 #if INV3_ENABLE_FIFO_LOGGING
     const uint64_t tstart = AP_HAL::micros64();
 #endif
+    Vector3f gyro[INV3_FIFO_BUFFER_LEN];
+    uint8_t n_gyro = 0;
+    bool ret = true;
+
     for (uint8_t i = 0; i < n_samples; i++) {
         const FIFOData &d = data[i];
 
@@ -418,32 +428,32 @@ bool AP_InertialSensor_Invensensev3::accumulate_samples(const FIFOData *data, ui
         // ICM45686 - TMST_FIELD_EN bit 3 : 1
         // ICM42688 - HEADER_TIMESTAMP_FSYNC bit 2-3 : 10
         if ((d.header & 0xFC) != 0x68) { // ACCEL_EN | GYRO_EN | TMST_FIELD_EN
-            // no or bad data
-            return false;
+            // no or bad data, keep the good samples before it
+            ret = false;
+            break;
         }
 
         Vector3f accel{float(d.accel[0]), float(d.accel[1]), float(d.accel[2])};
-        Vector3f gyro{float(d.gyro[0]), float(d.gyro[1]), float(d.gyro[2])};
-
         accel *= accel_scale;
-        gyro *= gyro_scale;
+        gyro[n_gyro] = Vector3f{float(d.gyro[0]), float(d.gyro[1]), float(d.gyro[2])} * gyro_scale;
 
 #if INV3_ENABLE_FIFO_LOGGING
-        Write_GYR(gyro_instance, tstart+(i*backend_period_us), gyro, true);
+        Write_GYR(gyro_instance, tstart+(i*backend_period_us), gyro[n_gyro], true);
 #endif
+        n_gyro++;
 
         const float temp = d.temperature * temp_sensitivity + temp_zero;
 
-        // these four calls are about 40us
         _rotate_and_correct_accel(accel_instance, accel);
-        _rotate_and_correct_gyro(gyro_instance, gyro);
-
         _notify_new_accel_raw_sample(accel_instance, accel, 0);
-        _notify_new_gyro_raw_sample(gyro_instance, gyro);
 
         temp_filtered = temp_filter.apply(temp);
     }
-    return true;
+
+    _rotate_and_correct_gyro(gyro_instance, gyro, n_gyro);
+    _notify_new_gyro_raw_samples(gyro_instance, gyro, n_gyro);
+
+    return ret;
 }
 
 #if HAL_INS_HIGHRES_SAMPLE
@@ -468,38 +478,41 @@ static inline float uint20_to_float(uint8_t msb, uint8_t bits, uint8_t lsb)
 
 bool AP_InertialSensor_Invensensev3::accumulate_highres_samples(const FIFODataHighRes *data, uint8_t n_samples)
 {
+    Vector3f gyro[INV3_FIFO_BUFFER_LEN];
+    uint8_t n_gyro = 0;
+    bool ret = true;
+
     for (uint8_t i = 0; i < n_samples; i++) {
         const FIFODataHighRes &d = data[i];
 
         // we have a header to confirm we don't have FIFO corruption! no more mucking
         // about with the temperature registers
         if ((d.header & 0xFC) != 0x78) { // ACCEL_EN | GYRO_EN | HIRES_EN | TMST_FIELD_EN
-            // no or bad data
-            return false;
+            // no or bad data, keep the good samples before it
+            ret = false;
+            break;
         }
 
         Vector3f accel{uint20_to_float(d.accel[1], d.accel[0], d.ax),
             uint20_to_float(d.accel[3], d.accel[2], d.ay),
             uint20_to_float(d.accel[5], d.accel[4], d.az)};
-        Vector3f gyro{uint20_to_float(d.gyro[1], d.gyro[0], d.gx),
-            uint20_to_float(d.gyro[3], d.gyro[2], d.gy),
-            uint20_to_float(d.gyro[5], d.gyro[4], d.gz)};
-
         accel *= accel_scale;
-        gyro *= gyro_scale;
+        gyro[n_gyro++] = Vector3f{uint20_to_float(d.gyro[1], d.gyro[0], d.gx),
+            uint20_to_float(d.gyro[3], d.gyro[2], d.gy),
+            uint20_to_float(d.gyro[5], d.gyro[4], d.gz)} * gyro_scale;
 
         const float temp = d.temperature * temp_sensitivity + temp_zero;
 
-        // these four calls are about 40us
         _rotate_and_correct_accel(accel_instance, accel);
-        _rotate_and_correct_gyro(gyro_instance, gyro);
-
         _notify_new_accel_raw_sample(accel_instance, accel, 0);
-        _notify_new_gyro_raw_sample(gyro_instance, gyro);
 
         temp_filtered = temp_filter.apply(temp);
     }
-    return true;
+
+    _rotate_and_correct_gyro(gyro_instance, gyro, n_gyro);
+    _notify_new_gyro_raw_samples(gyro_instance, gyro, n_gyro);
+
+    return ret;
 }
 #endif
 
@@ -188,6 +188,15 @@ const AP_Param::GroupInfo AP_Logger::var_info[] = {
     // @RebootRequired: True
     AP_GROUPINFO("_MAX_FILES", 12, AP_Logger, _params.max_log_files, MAX_LOG_FILES),
 
+#if HAL_LOGGER_FILE_COMPRESSION_ENABLED
+    // @Param: _FILE_COMPRESS
+    // @DisplayName: Compress logs written by the file backend
+    // @Description: When enabled, new logs on the SD card are written as a series of compressed frames, typically taking a third to a half of the space. Logs downloaded over MAVLink are decompressed on the vehicle. Logs copied straight off the card need a log reader that understands the compressed format, such as Replay. Takes effect when the next log is started.
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    AP_GROUPINFO("_FILE_COMPRESS", 13, AP_Logger, _params.file_compress, 0),
+#endif
+
     AP_GROUPEND
 };
 
@@ -1123,10 +1132,73 @@ bool AP_Logger::assert_same_fmt_for_name(const AP_Logger::log_write_fmt *f,
 }
 #endif
 
+uint32_t AP_Logger::fmt_cache_hash(const char *name, bool direct_comp)
+{
+    if (!direct_comp) {
+        // Fibonacci hash of the pointer
+        return uint32_t(uintptr_t(name) >> 2) * 2654435761U;
+    }
+    // FNV-1a of the string
+    uint32_t hash = 2166136261U;
+    for (const char *p = name; *p; p++) {
+        hash ^= uint8_t(*p);
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+/*
+  look up a format in fmt_cache without taking log_write_fmts_sem
+ */
+AP_Logger::log_write_fmt *AP_Logger::fmt_cache_find(const char *name, bool direct_comp) const
+{
+    const uint32_t hash = fmt_cache_hash(name, direct_comp);
+    for (uint8_t i=0; i<LOGGER_FMT_CACHE_PROBES; i++) {
+        struct log_write_fmt *f = fmt_cache[(hash + i) % LOGGER_FMT_CACHE_SIZE].load(std::memory_order_acquire);
+        if (f == nullptr) {
+            return nullptr;
+        }
+        if (direct_comp ? (strcmp(f->name, name) == 0) : (f->name == name)) {
+            return f;
+        }
+    }
+    return nullptr;
+}
+
+/*
+  add a format to fmt_cache. Must be called with log_write_fmts_sem
+  held. If all probe slots are used the format is only found via
+  the log_write_fmts list
+ */
+void AP_Logger::fmt_cache_insert(struct log_write_fmt *f, bool direct_comp)
+{
+    const uint32_t hash = fmt_cache_hash(f->name, direct_comp);
+    for (uint8_t i=0; i<LOGGER_FMT_CACHE_PROBES; i++) {
+        auto &slot = fmt_cache[(hash + i) % LOGGER_FMT_CACHE_SIZE];
+        const struct log_write_fmt *s = slot.load(std::memory_order_relaxed);
+        if (s == f) {
+            return;
+        }
+        if (s == nullptr) {
+            slot.store(f, std::memory_order_release);
+            return;
+        }
+    }
+}
+
 AP_Logger::log_write_fmt *AP_Logger::msg_fmt_for_name(const char *name, const char *labels, const char *units, const char *mults, const char *fmt, const bool direct_comp, const bool copy_strings)
 {
+    struct log_write_fmt *f = fmt_cache_find(name, direct_comp);
+    if (f != nullptr) {
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+        if (!assert_same_fmt_for_name(f, name, labels, units, mults, fmt)) {
+            return nullptr;
+        }
+#endif
+        return f;
+    }
+
     WITH_SEMAPHORE(log_write_fmts_sem);
-    struct log_write_fmt *f;
     for (f = log_write_fmts; f; f=f->next) {
         if (!direct_comp) {
             if (f->name == name) { // ptr comparison
@@ -1136,6 +1208,7 @@ AP_Logger::log_write_fmt *AP_Logger::msg_fmt_for_name(const char *name, const ch
                     return nullptr;
                 }
 #endif
+                fmt_cache_insert(f, direct_comp);
                 return f;
             }
         } else {
@@ -1147,6 +1220,7 @@ AP_Logger::log_write_fmt *AP_Logger::msg_fmt_for_name(const char *name, const ch
                     return nullptr;
                 }
 #endif
+                fmt_cache_insert(f, direct_comp);
                 return f;
             }
         }
@@ -1248,6 +1322,8 @@ AP_Logger::log_write_fmt *AP_Logger::msg_fmt_for_name(const char *name, const ch
     }
 #endif
 
+    fmt_cache_insert(f, direct_comp);
+
     return f;
 }
 
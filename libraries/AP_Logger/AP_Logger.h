@@ -15,6 +15,7 @@
 #include <AP_Vehicle/ModeReason.h>
 
 #include <stdint.h>
+#include <atomic>
 
 #include "LoggerMessageWriter.h"
 
@@ -340,6 +341,9 @@ public:
         AP_Float blk_ratemax;
         AP_Float disarm_ratemax;
         AP_Int16 max_log_files;
+#if HAL_LOGGER_FILE_COMPRESSION_ENABLED
+        AP_Int8 file_compress;
+#endif
     } _params;
 
     const struct LogStructure *structure(uint16_t num) const;
@@ -446,6 +450,18 @@ private:
      */
     HAL_Semaphore log_write_fmts_sem;
 
+    /*
+      open-addressed cache of log_write_fmts, keyed on the name
+      pointer (or the name string for direct comparisons). Slots are
+      only ever filled, under log_write_fmts_sem, and formats are never
+      freed, so lookups of already registered formats don't need the
+      semaphore
+     */
+    std::atomic<struct log_write_fmt *> fmt_cache[LOGGER_FMT_CACHE_SIZE] {};
+    static uint32_t fmt_cache_hash(const char *name, bool direct_comp);
+    struct log_write_fmt *fmt_cache_find(const char *name, bool direct_comp) const;
+    void fmt_cache_insert(struct log_write_fmt *f, bool direct_comp);
+
     // return (possibly allocating) a log_write_fmt for a name
     const struct log_write_fmt *log_write_fmt_for_msg_type(uint8_t msg_type) const;
 
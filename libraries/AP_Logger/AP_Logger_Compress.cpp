@@ -0,0 +1,425 @@
+/*
+  framed, streaming compressed log format for the File backend
+ */
+
+#include "AP_Logger_Compress.h"
+
+#if HAL_LOGGER_FILE_COMPRESSION_ENABLED
+
+#include <stdlib.h>
+#include <string.h>
+#include <AP_Filesystem/AP_Filesystem.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/crc.h>
+
+// LZ4 block format limits
+#define LZ_MIN_MATCH      4
+#define LZ_LAST_LITERALS  5   // the last bytes of a block are always literals
+#define LZ_MFLIMIT        12  // no match may start closer than this to the end
+
+static inline uint32_t lz_read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint16_t lz_hash(uint32_t v)
+{
+    return (v * 2654435761U) >> (32 - AP_Logger_LZ::hash_bits);
+}
+
+// write an LZ4 length extension
+static bool lz_put_length(uint8_t *dst, uint16_t dst_size, uint16_t &op, uint32_t len)
+{
+    while (len >= 255) {
+        if (op >= dst_size) {
+            return false;
+        }
+        dst[op++] = 255;
+        len -= 255;
+    }
+    if (op >= dst_size) {
+        return false;
+    }
+    dst[op++] = len;
+    return true;
+}
+
+// write one sequence of literals followed by an optional match
+static bool lz_put_sequence(uint8_t *dst, uint16_t dst_size, uint16_t &op,
+                            const uint8_t *literals, uint16_t lit_len,
+                            uint16_t offset, uint16_t match_len)
+{
+    if (op >= dst_size) {
+        return false;
+    }
+    const uint32_t mlen = match_len > 0 ? match_len - LZ_MIN_MATCH : 0;
+    dst[op++] = (MIN(lit_len, 15U) << 4) | MIN(mlen, 15U);
+    if (lit_len >= 15 && !lz_put_length(dst, dst_size, op, lit_len - 15)) {
+        return false;
+    }
+    if (op + lit_len > dst_size) {
+        return false;
+    }
+    memcpy(&dst[op], literals, lit_len);
+    op += lit_len;
+    if (match_len == 0) {
+        return true;
+    }
+    if (op + 2 > dst_size) {
+        return false;
+    }
+    dst[op++] = offset & 0xFF;
+    dst[op++] = offset >> 8;
+    if (mlen >= 15 && !lz_put_length(dst, dst_size, op, mlen - 15)) {
+        return false;
+    }
+    return true;
+}
+
+uint16_t AP_Logger_LZ::compress(const uint8_t *src, uint16_t len, uint8_t *dst, uint16_t dst_size, uint16_t *hash_table)
+{
+    uint16_t op = 0;
+    uint16_t anchor = 0;
+
+    if (len >= LZ_MFLIMIT) {
+        memset(hash_table, 0, sizeof(uint16_t) << hash_bits);
+        const uint16_t limit = len - LZ_MFLIMIT;
+        uint16_t ip = 1;
+        while (ip <= limit) {
+            const uint32_t seq = lz_read32(&src[ip]);
+            const uint16_t h = lz_hash(seq);
+            const uint16_t ref = hash_table[h];
+            hash_table[h] = ip;
+            if (ref >= ip || lz_read32(&src[ref]) != seq) {
+                // step faster through data which is not matching
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+            uint16_t match_len = LZ_MIN_MATCH;
+            const uint16_t max_len = len - LZ_LAST_LITERALS - ip;
+            while (match_len < max_len && src[ref+match_len] == src[ip+match_len]) {
+                match_len++;
+            }
+            if (!lz_put_sequence(dst, dst_size, op, &src[anchor], ip - anchor, ip - ref, match_len)) {
+                return 0;
+            }
+            ip += match_len;
+            anchor = ip;
+            if (ip - 2 > 0 && ip <= limit) {
+                // prime the table with the end of the match
+                hash_table[lz_hash(lz_read32(&src[ip-2]))] = ip - 2;
+            }
+        }
+    }
+
+    // the remaining bytes are literals
+    if (!lz_put_sequence(dst, dst_size, op, &src[anchor], len - anchor, 0, 0)) {
+        return 0;
+    }
+    return op;
+}
+
+// read an LZ4 length extension
+static bool lz_get_length(const uint8_t *src, uint16_t len, uint16_t &ip, uint32_t &value)
+{
+    uint8_t b;
+    do {
+        if (ip >= len) {
+            return false;
+        }
+        b = src[ip++];
+        value += b;
+    } while (b == 255);
+    return true;
+}
+
+bool AP_Logger_LZ::decompress(const uint8_t *src, uint16_t len, uint8_t *dst, uint16_t raw_len)
+{
+    uint16_t ip = 0;
+    uint32_t op = 0;
+
+    while (ip < len) {
+        const uint8_t token = src[ip++];
+        uint32_t lit_len = token >> 4;
+        if (lit_len == 15 && !lz_get_length(src, len, ip, lit_len)) {
+            return false;
+        }
+        if (ip + lit_len > len || op + lit_len > raw_len) {
+            return false;
+        }
+        memcpy(&dst[op], &src[ip], lit_len);
+        ip += lit_len;
+        op += lit_len;
+        if (ip == len) {
+            // the last sequence has no match
+            break;
+        }
+        if (ip + 2 > len) {
+            return false;
+        }
+        const uint16_t offset = src[ip] | (src[ip+1] << 8);
+        ip += 2;
+        uint32_t match_len = token & 0x0F;
+        if (match_len == 15 && !lz_get_length(src, len, ip, match_len)) {
+            return false;
+        }
+        match_len += LZ_MIN_MATCH;
+        if (offset == 0 || offset > op || op + match_len > raw_len) {
+            return false;
+        }
+        // matches may overlap the bytes they produce
+        const uint8_t *ref = &dst[op - offset];
+        for (uint32_t i=0; i<match_len; i++) {
+            dst[op+i] = ref[i];
+        }
+        op += match_len;
+    }
+    return op == raw_len;
+}
+
+static uint16_t frame_header_crc(const log_FrameHeader &hdr)
+{
+    return crc16_ccitt((const uint8_t *)&hdr, offsetof(log_FrameHeader, crc), 0);
+}
+
+AP_Logger_FrameWriter::~AP_Logger_FrameWriter()
+{
+    free(hash_table);
+    free(frame);
+}
+
+bool AP_Logger_FrameWriter::init()
+{
+    if (frame != nullptr) {
+        return true;
+    }
+    hash_table = (uint16_t *)malloc(sizeof(uint16_t) << AP_Logger_LZ::hash_bits);
+    frame = (uint8_t *)malloc(sizeof(log_FrameHeader) + LOGGER_FRAME_DATA_MAX);
+    if (hash_table == nullptr || frame == nullptr) {
+        free(hash_table);
+        free(frame);
+        hash_table = nullptr;
+        frame = nullptr;
+        return false;
+    }
+    return true;
+}
+
+uint16_t AP_Logger_FrameWriter::add_frame(const uint8_t *src, uint32_t len, uint32_t raw_offset)
+{
+    const uint16_t raw_len = MIN(len, uint32_t(LOGGER_FRAME_RAW_MAX));
+    uint8_t *data = &frame[sizeof(log_FrameHeader)];
+
+    // keep the compressed form only if it is smaller
+    uint16_t data_len = AP_Logger_LZ::compress(src, raw_len, data, raw_len-1, hash_table);
+    if (data_len == 0) {
+        memcpy(data, src, raw_len);
+        data_len = raw_len;
+    }
+
+    log_FrameHeader hdr {};
+    hdr.magic = LOGGER_FRAME_MAGIC;
+    hdr.raw_offset = raw_offset;
+    hdr.data_len = data_len;
+    hdr.raw_len = raw_len;
+    hdr.crc = frame_header_crc(hdr);
+    memcpy(frame, &hdr, sizeof(hdr));
+
+    pending_ofs = 0;
+    pending_len = sizeof(hdr) + data_len;
+    return raw_len;
+}
+
+void AP_Logger_FrameWriter::advance(uint32_t len)
+{
+    pending_ofs = MIN(pending_ofs + len, pending_len);
+    if (pending_ofs == pending_len) {
+        reset();
+    }
+}
+
+AP_Logger_FrameReader::~AP_Logger_FrameReader()
+{
+    free(raw);
+    free(data);
+}
+
+bool AP_Logger_FrameReader::header_valid(const log_FrameHeader &hdr)
+{
+    return hdr.magic == LOGGER_FRAME_MAGIC &&
+        hdr.raw_len > 0 &&
+        hdr.raw_len <= LOGGER_FRAME_RAW_MAX &&
+        hdr.data_len <= hdr.raw_len &&
+        hdr.crc == frame_header_crc(hdr);
+}
+
+bool AP_Logger_FrameReader::is_compressed(int _fd)
+{
+    log_FrameHeader hdr;
+    if (AP::FS().lseek(_fd, 0, SEEK_SET) != 0 ||
+        AP::FS().read(_fd, &hdr, sizeof(hdr)) != sizeof(hdr)) {
+        return false;
+    }
+    return header_valid(hdr);
+}
+
+/*
+  the last complete frame starts within two frames of the end of the
+  file, even if the final frame was cut short. Scan that window for
+  the frame which ends furthest into the uncompressed log
+ */
+uint32_t AP_Logger_FrameReader::raw_size(int _fd, uint32_t file_size)
+{
+    const uint32_t frame_max = sizeof(log_FrameHeader) + LOGGER_FRAME_DATA_MAX;
+    const uint32_t window = MIN(file_size, 2 * frame_max);
+    const uint32_t window_start = file_size - window;
+    uint8_t *buf = (uint8_t *)malloc(window);
+    if (buf == nullptr) {
+        return 0;
+    }
+    uint32_t ret = 0;
+    if (AP::FS().lseek(_fd, window_start, SEEK_SET) == (off_t)window_start &&
+        AP::FS().read(_fd, buf, window) == (ssize_t)window) {
+        for (uint32_t i=0; i + sizeof(log_FrameHeader) <= window; i++) {
+            if (buf[i] != (LOGGER_FRAME_MAGIC & 0xFF)) {
+                continue;
+            }
+            log_FrameHeader hdr;
+            memcpy(&hdr, &buf[i], sizeof(hdr));
+            if (!header_valid(hdr) ||
+                i + sizeof(hdr) + hdr.data_len > window) {
+                continue;
+            }
+            ret = MAX(ret, hdr.raw_offset + hdr.raw_len);
+        }
+    }
+    free(buf);
+    return ret;
+}
+
+bool AP_Logger_FrameReader::open(int _fd)
+{
+    if (raw == nullptr) {
+        raw = (uint8_t *)malloc(LOGGER_FRAME_RAW_MAX);
+        data = (uint8_t *)malloc(LOGGER_FRAME_DATA_MAX);
+        if (raw == nullptr || data == nullptr) {
+            free(raw);
+            free(data);
+            raw = nullptr;
+            data = nullptr;
+            return false;
+        }
+    }
+    fd = _fd;
+    frame_raw_offset = 0;
+    frame_raw_len = 0;
+    next_file_ofs = 0;
+    index_len = 0;
+    index_spacing = 4 * LOGGER_FRAME_RAW_MAX;
+    return true;
+}
+
+/*
+  remember where a frame starts if it is far enough past the last
+  frame indexed
+ */
+void AP_Logger_FrameReader::index_frame(uint32_t raw_offset, uint32_t file_ofs)
+{
+    if (index_len > 0 &&
+        raw_offset < index[index_len-1].raw_offset + index_spacing) {
+        return;
+    }
+    if (index_len == LOGGER_FRAME_INDEX_SIZE) {
+        // keep every other entry
+        for (uint8_t i=0; i<LOGGER_FRAME_INDEX_SIZE/2; i++) {
+            index[i] = index[2*i];
+        }
+        index_len = LOGGER_FRAME_INDEX_SIZE/2;
+        index_spacing *= 2;
+        if (raw_offset < index[index_len-1].raw_offset + index_spacing) {
+            return;
+        }
+    }
+    index[index_len].raw_offset = raw_offset;
+    index[index_len].file_ofs = file_ofs;
+    index_len++;
+}
+
+bool AP_Logger_FrameReader::read_header(uint32_t file_ofs, log_FrameHeader &hdr)
+{
+    return AP::FS().lseek(fd, file_ofs, SEEK_SET) == (off_t)file_ofs &&
+        AP::FS().read(fd, &hdr, sizeof(hdr)) == sizeof(hdr) &&
+        header_valid(hdr);
+}
+
+ssize_t AP_Logger_FrameReader::read(uint32_t ofs, uint8_t *buf, uint32_t len)
+{
+    uint32_t total = 0;
+    while (total < len) {
+        const ssize_t n = read_frame(ofs + total, &buf[total], len - total);
+        if (n < 0) {
+            return total > 0 ? ssize_t(total) : n;
+        }
+        if (n == 0) {
+            break;
+        }
+        total += n;
+    }
+    return total;
+}
+
+ssize_t AP_Logger_FrameReader::read_frame(uint32_t ofs, uint8_t *buf, uint32_t len)
+{
+    if (fd == -1) {
+        return -1;
+    }
+    if (ofs < frame_raw_offset) {
+        // going backwards, start again from the last indexed frame
+        // before ofs
+        frame_raw_offset = 0;
+        frame_raw_len = 0;
+        next_file_ofs = 0;
+        for (uint8_t i=index_len; i>0; i--) {
+            if (index[i-1].raw_offset <= ofs) {
+                frame_raw_offset = index[i-1].raw_offset;
+                next_file_ofs = index[i-1].file_ofs;
+                break;
+            }
+        }
+    }
+    while (ofs >= frame_raw_offset + frame_raw_len) {
+        // move to the next frame, only decoding it if it holds ofs
+        log_FrameHeader hdr;
+        if (!read_header(next_file_ofs, hdr)) {
+            // end of the log
+            return 0;
+        }
+        index_frame(hdr.raw_offset, next_file_ofs);
+        next_file_ofs += sizeof(hdr) + hdr.data_len;
+        if (ofs >= hdr.raw_offset + hdr.raw_len) {
+            frame_raw_offset = hdr.raw_offset;
+            frame_raw_len = 0;
+            continue;
+        }
+        uint8_t *dst = hdr.data_len == hdr.raw_len ? raw : data;
+        if (AP::FS().read(fd, dst, hdr.data_len) != hdr.data_len) {
+            return 0;
+        }
+        if (dst == data && !AP_Logger_LZ::decompress(data, hdr.data_len, raw, hdr.raw_len)) {
+            return -1;
+        }
+        frame_raw_offset = hdr.raw_offset;
+        frame_raw_len = hdr.raw_len;
+    }
+    if (ofs < frame_raw_offset) {
+        // a gap in the log
+        return -1;
+    }
+    const uint32_t n = MIN(len, frame_raw_offset + frame_raw_len - ofs);
+    memcpy(buf, &raw[ofs - frame_raw_offset], n);
+    return n;
+}
+
+#endif  // HAL_LOGGER_FILE_COMPRESSION_ENABLED
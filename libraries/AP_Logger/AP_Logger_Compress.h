@@ -0,0 +1,135 @@
+/*
+  framed, streaming compressed log format for the File backend
+
+  A compressed log is a sequence of frames, each holding up to
+  LOGGER_FRAME_RAW_MAX bytes of normal log data compressed with a
+  small LZ77 codec using the LZ4 block layout. Every frame starts with
+  a header giving its offset in the uncompressed log, so a reader can
+  seek by skipping whole frames, and can find the end of a log that
+  was cut short by power loss.
+ */
+#pragma once
+
+#include "AP_Logger_config.h"
+
+#if HAL_LOGGER_FILE_COMPRESSION_ENABLED
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <AP_Common/AP_Common.h>
+
+#define LOGGER_FRAME_MAGIC 0x5A4C5041 // "APLZ"
+
+// uncompressed bytes in a frame
+#define LOGGER_FRAME_RAW_MAX 16384
+
+// worst case size of frame data, for data which does not compress
+// the frame holds it stored
+#define LOGGER_FRAME_DATA_MAX LOGGER_FRAME_RAW_MAX
+
+// frames indexed by AP_Logger_FrameReader for seeking backwards
+#define LOGGER_FRAME_INDEX_SIZE 64
+
+/*
+  the uncompressed log is limited to 4GB by raw_offset. The File
+  backend starts a new log before it would wrap
+ */
+struct PACKED log_FrameHeader {
+    uint32_t magic;
+    uint32_t raw_offset;  // offset of the frame in the uncompressed log
+    uint16_t data_len;    // bytes of data after the header
+    uint16_t raw_len;     // uncompressed bytes, data is stored if equal to data_len
+    uint16_t crc;         // crc16_ccitt of the fields above
+};
+
+namespace AP_Logger_LZ {
+    static const uint8_t hash_bits = 12;
+
+    // compress len bytes from src into dst, using a hash table of
+    // (1<<hash_bits) entries. Returns the compressed length, or zero
+    // if it would not fit in dst_size bytes
+    uint16_t compress(const uint8_t *src, uint16_t len, uint8_t *dst, uint16_t dst_size, uint16_t *hash_table);
+
+    // decompress exactly raw_len bytes, returning false on any
+    // malformed input
+    bool decompress(const uint8_t *src, uint16_t len, uint8_t *dst, uint16_t raw_len);
+}
+
+/*
+  compress log data into frames in the logger IO thread
+ */
+class AP_Logger_FrameWriter {
+public:
+    ~AP_Logger_FrameWriter();
+
+    bool init();
+
+    // build a frame from the start of len bytes of log data at
+    // raw_offset in the log, returning the number of bytes used
+    uint16_t add_frame(const uint8_t *src, uint32_t len, uint32_t raw_offset);
+
+    // frame bytes still to be written to the file
+    const uint8_t *pending(uint32_t &len) const {
+        len = pending_len - pending_ofs;
+        return &frame[pending_ofs];
+    }
+    void advance(uint32_t len);
+
+    void reset() {
+        pending_ofs = pending_len = 0;
+    }
+
+private:
+    uint16_t *hash_table = nullptr;
+    uint8_t *frame = nullptr;
+    uint32_t pending_ofs;
+    uint32_t pending_len;
+};
+
+/*
+  random access to the uncompressed contents of a compressed log
+ */
+class AP_Logger_FrameReader {
+public:
+    ~AP_Logger_FrameReader();
+
+    // return true if the open file starts with a compressed frame
+    static bool is_compressed(int fd);
+
+    // return the uncompressed size of a compressed log file
+    static uint32_t raw_size(int fd, uint32_t file_size);
+
+    bool open(int fd);
+
+    // read uncompressed log data at ofs, crossing frames as needed.
+    // Returns less than len only at the end of the log, 0 at the end
+    // of the log and -1 on error
+    ssize_t read(uint32_t ofs, uint8_t *buf, uint32_t len);
+
+private:
+    static bool header_valid(const log_FrameHeader &hdr);
+    // read from the frame holding ofs, stopping at the end of the frame
+    ssize_t read_frame(uint32_t ofs, uint8_t *buf, uint32_t len);
+    void index_frame(uint32_t raw_offset, uint32_t file_ofs);
+    bool read_header(uint32_t file_ofs, log_FrameHeader &hdr);
+
+    int fd = -1;
+    uint8_t *raw = nullptr;
+    uint8_t *data = nullptr;
+    uint32_t frame_raw_offset;
+    uint32_t frame_raw_len;
+    uint32_t next_file_ofs;
+
+    // file offsets of frames at least index_spacing apart in the
+    // uncompressed log, so seeking backwards doesn't rescan the log
+    // from the start. The spacing doubles each time the index fills
+    struct {
+        uint32_t raw_offset;
+        uint32_t file_ofs;
+    } index[LOGGER_FRAME_INDEX_SIZE];
+    uint8_t index_len;
+    uint32_t index_spacing;
+};
+
+#endif  // HAL_LOGGER_FILE_COMPRESSION_ENABLED
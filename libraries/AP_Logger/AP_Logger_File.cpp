@@ -91,6 +91,13 @@ void AP_Logger_File::Init()
 
     DEV_PRINTF("AP_Logger_File: buffer size=%u\n", (unsigned)bufsize);
 
+#if HAL_LOGGER_FILE_STAGING_ENABLED && !APM_BUILD_TYPE(APM_BUILD_Replay)
+    // without a staging buffer the main thread waits for the semaphore
+    if (!_staging.set_size(HAL_LOGGER_FILE_STAGING_SIZE)) {
+        DEV_PRINTF("AP_Logger_File: no staging buffer\n");
+    }
+#endif
+
     _initialised = true;
 
     const char* custom_dir = hal.util->get_custom_log_directory();
@@ -441,6 +448,13 @@ void AP_Logger_File::EraseAll()
     erase.was_logging = (_write_fd != -1);
     stop_logging();
 
+#if HAL_LOGGER_FILE_COMPRESSION_ENABLED
+    // log numbers will be reused
+    if (_log_size_cache != nullptr) {
+        memset(_log_size_cache, 0, HAL_LOGGER_FILE_SIZE_CACHE_SIZE * sizeof(log_size_cache_entry));
+    }
+#endif
+
     erase.log_num = 1;
 }
 
@@ -472,8 +486,30 @@ bool AP_Logger_File::StartNewLogOK() const
 /* Write a block of data at current offset */
 bool AP_Logger_File::_WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical)
 {
+#if HAL_LOGGER_FILE_STAGING_ENABLED
+    if (_staging.get_size() != 0 && hal.scheduler->in_main_thread()) {
+        if (!semaphore.take_nonblocking()) {
+            // another thread is writing, don't wait for it
+            return stage_block(pBuffer, size, is_critical);
+        }
+        merge_staged_blocks();
+        const bool ret = write_block(pBuffer, size, is_critical);
+        semaphore.give();
+        return ret;
+    }
+#endif
+
     WITH_SEMAPHORE(semaphore);
 
+#if HAL_LOGGER_FILE_STAGING_ENABLED
+    // keep the main thread's blocks ahead of ours
+    merge_staged_blocks();
+#endif
+    return write_block(pBuffer, size, is_critical);
+}
+
+bool AP_Logger_File::write_block(const void *pBuffer, uint16_t size, bool is_critical)
+{
     if (! WriteBlockCheckStartupMessages()) {
         _dropped++;
         return false;
@@ -522,6 +558,96 @@ bool AP_Logger_File::_WritePrioritisedBlock(const void *pBuffer, uint16_t size,
     return true;
 }
 
+#if HAL_LOGGER_FILE_STAGING_ENABLED
+/*
+  stage a block from the main thread without taking semaphore. Staged
+  blocks count against _writebuf space for the critical message
+  reservation as they will end up there. Drops are counted in
+  _staging_dropped, as _dropped is only updated with semaphore held
+ */
+bool AP_Logger_File::stage_block(const void *pBuffer, uint16_t size, bool is_critical)
+{
+    if (!WriteBlockCheckStartupMessages()) {
+        _staging_dropped++;
+        return false;
+    }
+
+    if (_staging.space() < size + sizeof(size)) {
+        if (_writing_startup_messages) {
+            // this message isn't dropped, it will be sent again...
+            return false;
+        }
+        _staging_dropped++;
+        return false;
+    }
+    if (!is_critical && !_writing_startup_messages &&
+        _writebuf.space() < _staging.available() + size + critical_message_reserved_space(_writebuf.get_size())) {
+        _staging_dropped++;
+        return false;
+    }
+
+    // the length goes in first, merge_staged_blocks() waits for
+    // the whole block to be available
+    _staging.write((const uint8_t *)&size, sizeof(size));
+    _staging.write((const uint8_t *)pBuffer, size);
+    return true;
+}
+
+/*
+  move complete staged blocks into _writebuf, called with semaphore
+  held so there is only one consumer of _staging
+ */
+void AP_Logger_File::merge_staged_blocks()
+{
+    merge_staged_dropped();
+
+    uint16_t size;
+    while (_staging.peekbytes((uint8_t *)&size, sizeof(size)) == sizeof(size) &&
+           _staging.available() >= size + sizeof(size) &&
+           _writebuf.space() >= size) {
+        _staging.advance(sizeof(size));
+        uint32_t remaining = size;
+        while (remaining > 0) {
+            uint32_t n;
+            const uint8_t *ptr = _staging.readptr(n);
+            n = MIN(n, remaining);
+            _writebuf.write(ptr, n);
+            _staging.advance(n);
+            remaining -= n;
+        }
+        df_stats_gather(size, _writebuf.space());
+    }
+}
+
+/*
+  drop staged blocks when starting a new log, they would otherwise
+  land ahead of its format messages. Only whole blocks are dropped, as
+  the main thread may be part way through staging one
+ */
+void AP_Logger_File::discard_staged_blocks()
+{
+    WITH_SEMAPHORE(semaphore);
+    merge_staged_dropped();
+
+    uint16_t size;
+    while (_staging.peekbytes((uint8_t *)&size, sizeof(size)) == sizeof(size) &&
+           _staging.available() >= size + sizeof(size)) {
+        _staging.advance(size + sizeof(size));
+    }
+}
+
+/*
+  add drops counted by the main thread while staging to _dropped,
+  called with semaphore held
+ */
+void AP_Logger_File::merge_staged_dropped()
+{
+    const uint32_t staging_dropped = _staging_dropped;
+    _dropped += staging_dropped - _staging_dropped_merged;
+    _staging_dropped_merged = staging_dropped;
+}
+#endif // HAL_LOGGER_FILE_STAGING_ENABLED
+
 /*
   find the highest log number
  */
@@ -568,9 +694,54 @@ uint32_t AP_Logger_File::_get_log_size(const uint16_t log_num)
         free(fname);
         return 0;
     }
+#if HAL_LOGGER_FILE_COMPRESSION_ENABLED
+    // report the uncompressed size, as that is what we send in log
+    // downloads
+    const uint32_t size = _get_raw_log_size(fname, log_num, st.st_size);
+    free(fname);
+    return size;
+#else
     free(fname);
     return st.st_size;
+#endif
+}
+
+#if HAL_LOGGER_FILE_COMPRESSION_ENABLED
+/*
+  find the uncompressed size of a log, using the cached size if the
+  file hasn't changed since we last looked at it
+ */
+uint32_t AP_Logger_File::_get_raw_log_size(const char *fname, uint16_t log_num, uint32_t file_size)
+{
+    if (_log_size_cache == nullptr) {
+        _log_size_cache = (log_size_cache_entry *)calloc(HAL_LOGGER_FILE_SIZE_CACHE_SIZE, sizeof(log_size_cache_entry));
+    }
+    log_size_cache_entry *entry = nullptr;
+    if (_log_size_cache != nullptr) {
+        entry = &_log_size_cache[log_num % HAL_LOGGER_FILE_SIZE_CACHE_SIZE];
+        if (entry->log_num == log_num && entry->file_size == file_size) {
+            return entry->raw_size;
+        }
+    }
+
+    const int fd = AP::FS().open(fname, O_RDONLY);
+    if (fd == -1) {
+        return file_size;
+    }
+    uint32_t size = file_size;
+    if (AP_Logger_FrameReader::is_compressed(fd)) {
+        size = AP_Logger_FrameReader::raw_size(fd, file_size);
+    }
+    AP::FS().close(fd);
+
+    if (entry != nullptr) {
+        entry->log_num = log_num;
+        entry->file_size = file_size;
+        entry->raw_size = size;
+    }
+    return size;
 }
+#endif
 
 uint32_t AP_Logger_File::_get_log_time(const uint16_t log_num)
 {
@@ -662,9 +833,35 @@ int16_t AP_Logger_File::get_log_data(const uint16_t list_entry, const uint16_t p
         free(fname);
         _read_offset = 0;
         _read_fd_log_num = log_num;
+#if HAL_LOGGER_FILE_COMPRESSION_ENABLED
+        _read_compressed = false;
+        if (AP_Logger_FrameReader::is_compressed(_read_fd)) {
+            if (_frame_reader == nullptr) {
+                _frame_reader = new AP_Logger_FrameReader();
+            }
+            if (_frame_reader == nullptr || !_frame_reader->open(_read_fd)) {
+                AP::FS().close(_read_fd);
+                _read_fd = -1;
+                return -1;
+            }
+            _read_compressed = true;
+        } else if (AP::FS().lseek(_read_fd, 0, SEEK_SET) != 0) {
+            AP::FS().close(_read_fd);
+            _read_fd = -1;
+            return -1;
+        }
+#endif
     }
     uint32_t ofs = page * (uint32_t)LOGGER_PAGE_SIZE + offset;
 
+#if HAL_LOGGER_FILE_COMPRESSION_ENABLED
+    if (_read_compressed) {
+        // offsets are in the uncompressed log. Reads span frames, so
+        // a short read is only returned at the end of the log
+        return (int16_t)_frame_reader->read(ofs, data, len);
+    }
+#endif
+
     if (ofs != _read_offset) {
         if (AP::FS().lseek(_read_fd, ofs, SEEK_SET) == (off_t)-1) {
             AP::FS().close(_read_fd);
@@ -873,6 +1070,22 @@ void AP_Logger_File::start_new_log(void)
     _open_error_ms = 0;
     _write_offset = 0;
     _writebuf.clear();
+#if HAL_LOGGER_FILE_STAGING_ENABLED
+    discard_staged_blocks();
+#endif
+#if HAL_LOGGER_FILE_COMPRESSION_ENABLED
+    // the format is fixed for the life of a log
+    _compressing = false;
+    if (_front._params.file_compress) {
+        if (_frame_writer == nullptr) {
+            _frame_writer = new AP_Logger_FrameWriter();
+        }
+        if (_frame_writer != nullptr && _frame_writer->init()) {
+            _frame_writer->reset();
+            _compressing = true;
+        }
+    }
+#endif
     write_fd_semaphore.give();
 
     // now update lastlog.txt with the new log number
@@ -910,7 +1123,8 @@ void AP_Logger_File::flush(void)
 #if APM_BUILD_TYPE(APM_BUILD_Replay)
 {
     uint32_t tnow = AP_HAL::millis();
-    while (_write_fd != -1 && _initialised && !recent_open_error() && _writebuf.available()) {
+    while (_write_fd != -1 && _initialised && !recent_open_error() &&
+           (_writebuf.available() || pending_frame_bytes())) {
         // convince the IO timer that it really is OK to write out
         // less than _writebuf_chunk bytes:
         if (tnow > 2001) { // avoid resetting _last_write_time to 0
@@ -954,6 +1168,15 @@ void AP_Logger_File::io_timer(void)
         return;
     }
 
+#if HAL_LOGGER_FILE_STAGING_ENABLED
+    // pick up anything the main thread staged while it was
+    // contended, in case it hasn't written since
+    if (_staging.available() && semaphore.take_nonblocking()) {
+        merge_staged_blocks();
+        semaphore.give();
+    }
+#endif
+
     if (last_log_is_marked_discard && hal.util->get_soft_armed()) {
         // time to make the log permanent
         const auto log_num = find_last_log();
@@ -962,10 +1185,11 @@ void AP_Logger_File::io_timer(void)
     }
 
     uint32_t nbytes = _writebuf.available();
-    if (nbytes == 0) {
+    const uint32_t frame_bytes = pending_frame_bytes();
+    if (nbytes == 0 && frame_bytes == 0) {
         return;
     }
-    if (nbytes < _writebuf_chunk && 
+    if (frame_bytes == 0 && nbytes < _writebuf_chunk &&
         tnow - _last_write_time < 2000UL) {
         // write in _writebuf_chunk-sized chunks, but always write at
         // least once per 2 seconds if data is available
@@ -985,20 +1209,26 @@ void AP_Logger_File::io_timer(void)
     }
 
     _last_write_time = tnow;
-    if (nbytes > _writebuf_chunk) {
-        // be kind to the filesystem layer
-        nbytes = _writebuf_chunk;
-    }
+    const uint8_t *head = nullptr;
+#if HAL_LOGGER_FILE_COMPRESSION_ENABLED
+    if (!_compressing)
+#endif
+    {
+        if (nbytes > _writebuf_chunk) {
+            // be kind to the filesystem layer
+            nbytes = _writebuf_chunk;
+        }
 
-    uint32_t size;
-    const uint8_t *head = _writebuf.readptr(size);
-    nbytes = MIN(nbytes, size);
+        uint32_t size;
+        head = _writebuf.readptr(size);
+        nbytes = MIN(nbytes, size);
 
-    // try to align writes on a 512 byte boundary to avoid filesystem reads
-    if ((nbytes + _write_offset) % 512 != 0) {
-        uint32_t ofs = (nbytes + _write_offset) % 512;
-        if (ofs < nbytes) {
-            nbytes -= ofs;
+        // try to align writes on a 512 byte boundary to avoid filesystem reads
+        if ((nbytes + _write_offset) % 512 != 0) {
+            uint32_t ofs = (nbytes + _write_offset) % 512;
+            if (ofs < nbytes) {
+                nbytes -= ofs;
+            }
         }
     }
 
@@ -1010,6 +1240,26 @@ void AP_Logger_File::io_timer(void)
         write_fd_semaphore.give();
         return;
     }
+#if HAL_LOGGER_FILE_COMPRESSION_ENABLED
+    if (_compressing) {
+        // the log is written a frame at a time. Frames are built
+        // under the semaphore so a new log can't start mid-frame
+        if (frame_bytes == 0) {
+            if (_write_offset > UINT32_MAX - LOGGER_FRAME_RAW_MAX) {
+                // frame offsets are 32 bit, carry on in a new log
+                write_fd_semaphore.give();
+                start_new_log_pending = true;
+                return;
+            }
+            uint32_t size;
+            const uint8_t *raw = _writebuf.readptr(size);
+            const uint16_t used = _frame_writer->add_frame(raw, MIN(nbytes, size), _write_offset);
+            _writebuf.advance(used);
+            _write_offset += used;
+        }
+        head = _frame_writer->pending(nbytes);
+    }
+#endif
     ssize_t nwritten = AP::FS().write(_write_fd, head, nbytes);
     last_io_operation = "";
     if (nwritten <= 0) {
@@ -1027,8 +1277,15 @@ void AP_Logger_File::io_timer(void)
     } else {
         _last_write_failed = false;
         _last_write_ms = tnow;
-        _write_offset += nwritten;
-        _writebuf.advance(nwritten);
+#if HAL_LOGGER_FILE_COMPRESSION_ENABLED
+        if (_compressing) {
+            _frame_writer->advance(nwritten);
+        } else
+#endif
+        {
+            _write_offset += nwritten;
+            _writebuf.advance(nwritten);
+        }
         /*
           the best strategy for minimizing corruption on microSD cards
           seems to be to write in 4k chunks and fsync the file on each
@@ -1057,6 +1314,20 @@ void AP_Logger_File::io_timer(void)
     write_fd_semaphore.give();
 }
 
+/*
+  bytes of a compressed frame still to be written
+ */
+uint32_t AP_Logger_File::pending_frame_bytes() const
+{
+    uint32_t len = 0;
+#if HAL_LOGGER_FILE_COMPRESSION_ENABLED
+    if (_compressing) {
+        _frame_writer->pending(len);
+    }
+#endif
+    return len;
+}
+
 bool AP_Logger_File::io_thread_alive() const
 {
     if (!hal.scheduler->is_system_initialized()) {
@@ -10,6 +10,7 @@
 
 #include <AP_HAL/utility/RingBuffer.h>
 #include "AP_Logger_Backend.h"
+#include "AP_Logger_Compress.h"
 
 #if HAL_LOGGING_FILESYSTEM_ENABLED
 
@@ -17,6 +18,14 @@
 #define HAL_LOGGER_WRITE_CHUNK_SIZE 4096
 #endif
 
+#ifndef HAL_LOGGER_FILE_STAGING_SIZE
+#define HAL_LOGGER_FILE_STAGING_SIZE 4096
+#endif
+
+#ifndef HAL_LOGGER_FILE_SIZE_CACHE_SIZE
+#define HAL_LOGGER_FILE_SIZE_CACHE_SIZE 64
+#endif
+
 class AP_Logger_File : public AP_Logger_Backend
 {
 public:
@@ -86,6 +95,7 @@ private:
 
     uint32_t _io_timer_heartbeat;
     bool io_thread_alive() const;
+    uint32_t pending_frame_bytes() const;
     uint8_t io_thread_warning_decimation_counter;
 
     // do we have a recent open error?
@@ -104,6 +114,9 @@ private:
     bool dirent_to_log_num(const dirent *de, uint16_t &log_num) const;
     bool write_lastlog_file(uint16_t log_num);
 
+    // add a block to _writebuf, called with semaphore held
+    bool write_block(const void *pBuffer, uint16_t size, bool is_critical);
+
     // write buffer
     ByteBuffer _writebuf{0};
     const uint16_t _writebuf_chunk = HAL_LOGGER_WRITE_CHUNK_SIZE;
@@ -135,6 +148,22 @@ private:
     // bad fd
     HAL_Semaphore write_fd_semaphore;
 
+#if HAL_LOGGER_FILE_STAGING_ENABLED
+    // blocks from the main thread written while another thread held
+    // semaphore, each preceded by its uint16_t length. The main
+    // thread is the only producer, and whoever holds semaphore moves
+    // them into _writebuf
+    ByteBuffer _staging{0};
+    bool stage_block(const void *pBuffer, uint16_t size, bool is_critical);
+    void merge_staged_blocks();
+    void discard_staged_blocks();
+    // blocks dropped by stage_block(), only written by the main
+    // thread, and how many of them have been added to _dropped
+    volatile uint32_t _staging_dropped;
+    uint32_t _staging_dropped_merged;
+    void merge_staged_dropped();
+#endif
+
     // async erase state
     struct {
         bool was_logging;
@@ -144,6 +173,26 @@ private:
 
     const char *last_io_operation = "";
 
+#if HAL_LOGGER_FILE_COMPRESSION_ENABLED
+    // frames for the log being written, used when _compressing.
+    // _write_offset counts uncompressed bytes
+    AP_Logger_FrameWriter *_frame_writer;
+    bool _compressing;
+    // decoding of the log being read, used when _read_compressed
+    AP_Logger_FrameReader *_frame_reader;
+    bool _read_compressed;
+
+    // uncompressed log sizes, so listing logs doesn't open every log
+    // and decode the end of compressed ones each time. Direct mapped
+    // on log number, an entry is valid while the file size matches
+    struct log_size_cache_entry {
+        uint16_t log_num;
+        uint32_t file_size;
+        uint32_t raw_size;
+    } *_log_size_cache;
+    uint32_t _get_raw_log_size(const char *fname, uint16_t log_num, uint32_t file_size);
+#endif
+
     bool start_new_log_pending;
 };
 
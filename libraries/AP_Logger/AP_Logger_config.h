@@ -39,6 +39,33 @@
 
 #endif
 
+// framed LZ compression of File backend logs, see AP_Logger_Compress.h
+#ifndef HAL_LOGGER_FILE_COMPRESSION_ENABLED
+#define HAL_LOGGER_FILE_COMPRESSION_ENABLED HAL_LOGGING_FILESYSTEM_ENABLED && (HAL_MEM_CLASS >= HAL_MEM_CLASS_500)
+#endif
+
+// lock-free staging of main thread writes in the File backend, so
+// the fast loop never waits on another thread writing to the log
+#ifndef HAL_LOGGER_FILE_STAGING_ENABLED
+#define HAL_LOGGER_FILE_STAGING_ENABLED HAL_LOGGING_FILESYSTEM_ENABLED
+#endif
+
+// slots in the cache of formats registered by Write(name, ...)
+#ifndef LOGGER_FMT_CACHE_SIZE
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_500
+#define LOGGER_FMT_CACHE_SIZE 128U
+#elif HAL_MEM_CLASS >= HAL_MEM_CLASS_300
+#define LOGGER_FMT_CACHE_SIZE 64U
+#else
+#define LOGGER_FMT_CACHE_SIZE 32U
+#endif
+#endif
+
+// slots searched for a format before falling back to the list
+#ifndef LOGGER_FMT_CACHE_PROBES
+#define LOGGER_FMT_CACHE_PROBES 8U
+#endif
+
 #ifndef HAL_LOGGER_FILE_CONTENTS_ENABLED
 #define HAL_LOGGER_FILE_CONTENTS_ENABLED HAL_LOGGING_FILESYSTEM_ENABLED
 #endif
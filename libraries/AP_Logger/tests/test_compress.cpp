@@ -0,0 +1,115 @@
+#include <AP_gtest.h>
+
+#include <AP_Logger/AP_Logger_Compress.h>
+#include <AP_Filesystem/AP_Filesystem.h>
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if HAL_LOGGER_FILE_COMPRESSION_ENABLED
+
+static uint8_t src[LOGGER_FRAME_RAW_MAX];
+static uint8_t compressed[LOGGER_FRAME_DATA_MAX];
+static uint8_t decompressed[LOGGER_FRAME_RAW_MAX];
+static uint16_t hash_table[1U<<AP_Logger_LZ::hash_bits];
+
+static void check_round_trip(uint16_t len)
+{
+    const uint16_t n = AP_Logger_LZ::compress(src, len, compressed, len-1, hash_table);
+    if (n == 0) {
+        // incompressible, would be stored
+        return;
+    }
+    EXPECT_LT(n, len);
+    EXPECT_TRUE(AP_Logger_LZ::decompress(compressed, n, decompressed, len));
+    EXPECT_EQ(memcmp(src, decompressed, len), 0);
+}
+
+TEST(LoggerCompress, RoundTrip)
+{
+    // repeated log-like records with a changing timestamp
+    for (uint16_t i=0; i<sizeof(src); i++) {
+        src[i] = (i % 32) < 3 ? i : "\xa3\x95\x81IMU0 data"[i % 13];
+    }
+    for (uint16_t len : { 1, 12, 13, 100, 4096, 10000, LOGGER_FRAME_RAW_MAX }) {
+        check_round_trip(len);
+    }
+
+    // long runs need length extension bytes
+    memset(src, 0, sizeof(src));
+    check_round_trip(sizeof(src));
+
+    // random data should not compress
+    for (uint16_t i=0; i<sizeof(src); i++) {
+        src[i] = get_random16();
+    }
+    EXPECT_EQ(AP_Logger_LZ::compress(src, 4096, compressed, 4095, hash_table), 0);
+}
+
+TEST(LoggerCompress, Corrupt)
+{
+    memset(src, 0x55, sizeof(src));
+    const uint16_t n = AP_Logger_LZ::compress(src, 1000, compressed, 999, hash_table);
+    ASSERT_GT(n, 0);
+    // wrong expected length
+    EXPECT_FALSE(AP_Logger_LZ::decompress(compressed, n, decompressed, 999));
+    // truncated data
+    EXPECT_FALSE(AP_Logger_LZ::decompress(compressed, n-1, decompressed, 1000));
+    // match before the start of the output
+    compressed[2] = 0xFF;
+    EXPECT_FALSE(AP_Logger_LZ::decompress(compressed, n, decompressed, 1000));
+}
+
+/*
+  write a log through the frame writer and read it back the way log
+  download does, in 90 byte chunks that straddle frame boundaries
+ */
+TEST(LoggerCompress, FramedFile)
+{
+    static uint8_t log[2*LOGGER_FRAME_RAW_MAX + 1000];
+    for (uint32_t i=0; i<sizeof(log); i++) {
+        log[i] = (i % 32) < 3 ? get_random16() : "\xa3\x95\x81IMU0 data"[i % 13];
+    }
+
+    const char *fname = "test_compress.bin";
+    int fd = AP::FS().open(fname, O_WRONLY|O_CREAT|O_TRUNC);
+    ASSERT_NE(fd, -1);
+    AP_Logger_FrameWriter writer;
+    ASSERT_TRUE(writer.init());
+    uint32_t ofs = 0;
+    while (ofs < sizeof(log)) {
+        ofs += writer.add_frame(&log[ofs], sizeof(log) - ofs, ofs);
+        uint32_t len;
+        const uint8_t *frame = writer.pending(len);
+        ASSERT_EQ(AP::FS().write(fd, frame, len), ssize_t(len));
+        writer.advance(len);
+    }
+    AP::FS().close(fd);
+
+    fd = AP::FS().open(fname, O_RDONLY);
+    ASSERT_NE(fd, -1);
+    ASSERT_TRUE(AP_Logger_FrameReader::is_compressed(fd));
+    AP_Logger_FrameReader reader;
+    ASSERT_TRUE(reader.open(fd));
+
+    uint8_t buf[90];
+    for (ofs = 0; ofs + sizeof(buf) <= sizeof(log); ofs += sizeof(buf)) {
+        ASSERT_EQ(reader.read(ofs, buf, sizeof(buf)), ssize_t(sizeof(buf)));
+        ASSERT_EQ(memcmp(buf, &log[ofs], sizeof(buf)), 0);
+    }
+    // the last chunk is short, then the log ends
+    EXPECT_EQ(reader.read(ofs, buf, sizeof(buf)), ssize_t(sizeof(log) - ofs));
+    EXPECT_EQ(memcmp(buf, &log[ofs], sizeof(log) - ofs), 0);
+    EXPECT_EQ(reader.read(sizeof(log), buf, sizeof(buf)), 0);
+
+    // going back, as for a retransmitted chunk
+    EXPECT_EQ(reader.read(LOGGER_FRAME_RAW_MAX - 10, buf, sizeof(buf)), ssize_t(sizeof(buf)));
+    EXPECT_EQ(memcmp(buf, &log[LOGGER_FRAME_RAW_MAX - 10], sizeof(buf)), 0);
+
+    AP::FS().close(fd);
+    AP::FS().unlink(fname);
+}
+
+#endif  // HAL_LOGGER_FILE_COMPRESSION_ENABLED
+
+AP_GTEST_MAIN()
@@ -775,6 +775,14 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
         return false;
     }
 
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+    const Mission_Command *cached = cmd_cache_lookup(index);
+    if (cached != nullptr) {
+        cmd = *cached;
+        return true;
+    }
+#endif
+
     // ensure all bytes of cmd are zeroed
     cmd = {};
 
@@ -833,10 +841,74 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
     // set command's index to it's position in eeprom
     cmd.index = index;
 
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+    cmd_cache_insert(cmd);
+#endif
+
     // return success
     return true;
 }
 
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+/*
+  return the cached decode of a command, or nullptr if it isn't cached
+ */
+const AP_Mission::Mission_Command *AP_Mission::cmd_cache_lookup(uint16_t index) const
+{
+    if (_cmd_cache == nullptr) {
+        return nullptr;
+    }
+    const Mission_Command &slot = _cmd_cache[index % _cmd_cache_size];
+    if (slot.index != index) {
+        return nullptr;
+    }
+    return &slot;
+}
+
+/*
+  remember a decoded command. The cache is allocated on first use, so
+  vehicles that never load a mission don't pay for it, and sized to
+  the mission in steps of 32 commands up to AP_MISSION_CMD_CACHE_SIZE
+ */
+void AP_Mission::cmd_cache_insert(const Mission_Command &cmd) const
+{
+    if (_cmd_cache_failed) {
+        return;
+    }
+    const uint16_t wanted = MIN((_cmd_total + 31U) & ~31U, AP_MISSION_CMD_CACHE_SIZE);
+    if (_cmd_cache_size < wanted) {
+        // the mission has grown, start again with a larger cache
+        free(_cmd_cache);
+        _cmd_cache_size = 0;
+        _cmd_cache = (Mission_Command *)calloc(wanted, sizeof(Mission_Command));
+        if (_cmd_cache == nullptr) {
+            _cmd_cache_failed = true;
+            return;
+        }
+        _cmd_cache_size = wanted;
+        for (uint16_t i=0; i<_cmd_cache_size; i++) {
+            _cmd_cache[i].index = AP_MISSION_CMD_INDEX_NONE;
+        }
+    }
+    _cmd_cache[cmd.index % _cmd_cache_size] = cmd;
+}
+
+/*
+  drop a command from the cache. The next read decodes it from storage
+  again, so the cache always returns exactly what storage holds
+ */
+void AP_Mission::cmd_cache_invalidate(uint16_t index)
+{
+    if (_cmd_cache == nullptr) {
+        return;
+    }
+    Mission_Command &slot = _cmd_cache[index % _cmd_cache_size];
+    if (slot.index == index) {
+        slot.index = AP_MISSION_CMD_INDEX_NONE;
+    }
+}
+#endif // AP_MISSION_CMD_CACHE_SIZE
+
 bool AP_Mission::stored_in_location(uint16_t id)
 {
     switch (id) {
@@ -919,6 +991,10 @@ bool AP_Mission::write_cmd_to_storage(uint16_t index, const Mission_Command& cmd
         _storage.write_block(pos_in_storage+5, packed.bytes, 10);
     }
 
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+    cmd_cache_invalidate(index);
+#endif
+
     // remember when the mission last changed
     _last_change_time_ms = AP_HAL::millis();
 
@@ -2703,6 +2779,15 @@ const char *AP_Mission::Mission_Command::type() const
  */
 uint16_t AP_Mission::get_command_id(uint16_t index) const
 {
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+    {
+        WITH_SEMAPHORE(_rsem);
+        const Mission_Command *cached = cmd_cache_lookup(index);
+        if (cached != nullptr) {
+            return cached->id;
+        }
+    }
+#endif
     const uint16_t pos_in_storage = 4 + (index * AP_MISSION_EEPROM_COMMAND_SIZE);
     uint8_t b[3] {};
     if (!_storage.read_block(b, pos_in_storage, sizeof(b))) {
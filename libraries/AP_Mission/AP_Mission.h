@@ -884,6 +884,18 @@ private:
     // fast call to get command ID of a mission index
     uint16_t get_command_id(uint16_t index) const;
 
+#if AP_MISSION_CMD_CACHE_SIZE > 0
+    // direct-mapped cache of decoded commands, slot is index modulo
+    // _cmd_cache_size. Empty slots have an index of
+    // AP_MISSION_CMD_INDEX_NONE. Protected by _rsem
+    mutable Mission_Command *_cmd_cache = nullptr;
+    mutable uint16_t _cmd_cache_size = 0;
+    mutable bool _cmd_cache_failed = false;
+    const Mission_Command *cmd_cache_lookup(uint16_t index) const;
+    void cmd_cache_insert(const Mission_Command &cmd) const;
+    void cmd_cache_invalidate(uint16_t index);
+#endif
+
     // memoisation of contains-relative:
     bool _contains_terrain_alt_items;  // true if the mission has terrain-relative items
     uint32_t _last_contains_relative_calculated_ms;  // will be equal to _last_change_time_ms if _contains_terrain_alt_items is up-to-date
@@ -4,6 +4,19 @@
 #define AP_MISSION_ENABLED 1
 #endif
 
+// maximum number of decoded commands kept in RAM. The cache is sized
+// to the mission, so missions up to this size are fully cached and
+// larger ones keep a window around the indexes in use
+#ifndef AP_MISSION_CMD_CACHE_SIZE
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_1000
+#define AP_MISSION_CMD_CACHE_SIZE 1024
+#elif HAL_MEM_CLASS >= HAL_MEM_CLASS_500
+#define AP_MISSION_CMD_CACHE_SIZE 128
+#else
+#define AP_MISSION_CMD_CACHE_SIZE 0
+#endif
+#endif
+
 #ifndef AP_MISSION_NAV_PAYLOAD_PLACE_ENABLED
 #define AP_MISSION_NAV_PAYLOAD_PLACE_ENABLED 1
 #endif
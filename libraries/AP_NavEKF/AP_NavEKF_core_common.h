@@ -20,6 +20,18 @@
 #include <AP_Math/AP_Math.h>
 #include <AP_Math/vectorN.h>
 #include "AP_Nav_Common.h"
+#include <AP_NavEKF3/AP_NavEKF3_feature.h>
+
+/*
+  when EKF3 cores may be updated in parallel threads each core needs
+  its own scratch space, so the scratch variables become per-instance
+  members. Otherwise they stay static
+ */
+#if EK3_FEATURE_PARALLEL_CORES
+#define NAVEKF_CORE_SCRATCH
+#else
+#define NAVEKF_CORE_SCRATCH static
+#endif
 
 /*
   this declares a common parent class for AP_NavEKF2 and
@@ -29,7 +41,8 @@
   placing these in a common parent class we save a lot of memory, but
   we also save a lot of CPU (approx 10% on STM32F427) as the compiler
   is able to resolve the address of these variables at compile time,
-  which means significantly faster code
+  which means significantly faster code. See NAVEKF_CORE_SCRATCH for
+  builds where EKF3 cores run in parallel
  */
 class NavEKF_core_common {
 public:
@@ -42,10 +55,10 @@ public:
 #endif
 
 protected:
-    static Matrix24 KH;                   // intermediate result used for covariance updates
-    static Matrix24 KHP;                  // intermediate result used for covariance updates
-    static Matrix24 nextP;                // Predicted covariance matrix before addition of process noise to diagonals
-    static Vector28 Kfusion;              // intermediate fusion vector
+    NAVEKF_CORE_SCRATCH Matrix24 KH;      // intermediate result used for covariance updates
+    NAVEKF_CORE_SCRATCH Matrix24 KHP;     // intermediate result used for covariance updates
+    NAVEKF_CORE_SCRATCH Matrix24 nextP;   // Predicted covariance matrix before addition of process noise to diagonals
+    NAVEKF_CORE_SCRATCH Vector28 Kfusion; // intermediate fusion vector
 
     // fill all the common scratch variables with NaN on SITL
     void fill_scratch_variables(void);
@@ -10,6 +10,13 @@
 
 #include <new>
 
+// worker threads are only created on multi-core capable boards, never in replay
+#define EK3_CORE_WORKER_THREADS (EK3_FEATURE_PARALLEL_CORES && (CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL) && !APM_BUILD_TYPE(APM_BUILD_Replay) && !APM_BUILD_TYPE(APM_BUILD_AP_DAL_Standalone))
+
+#if EK3_CORE_WORKER_THREADS
+extern const AP_HAL::HAL& hal;
+#endif
+
 /*
   parameter defaults for different types of vehicle. The
   APM_BUILD_DIRECTORY is taken from the main vehicle directory name
@@ -734,6 +741,17 @@ const AP_Param::GroupInfo NavEKF3::var_info2[] = {
     // @Units: m
     AP_GROUPINFO("GPS_VACC_MAX", 10, NavEKF3, _gpsVAccThreshold, 0.0f),
 
+#if EK3_FEATURE_PARALLEL_CORES
+    // @Param: CORE_THREADS
+    // @DisplayName: Run EKF cores in parallel threads
+    // @Description: When enabled, EKF cores other than the first are updated in worker threads, each pinned to its own CPU, while the first core runs in the main thread. All cores finish before lane selection and outputs are used. On boards without thread support the cores run one after another with the same results. This option is intended for multi-core Linux flight computers.
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("CORE_THREADS", 11, NavEKF3, _coreThreads, 0),
+#endif
+
+
     AP_GROUPEND
 };
 
@@ -892,6 +910,150 @@ bool NavEKF3::coreBetterScore(uint8_t new_core, uint8_t current_core) const
     return coreRelativeErrors[new_core] < coreRelativeErrors[current_core];
 }
 
+/*
+  if we have not overrun by more than 3 IMU frames, and we have
+  already used more than 1/3 of the CPU budget for this loop then
+  suppress the prediction step. This allows multiple EKF instances to
+  cooperate on scheduling
+ */
+bool NavEKF3::allowStatePrediction(uint8_t i)
+{
+    if (core[i].getFramesSincePredict() < (_framesPerPrediction+3) &&
+        AP::dal().ekf_low_time_remaining(AP_DAL::EKFType::EKF3, i)) {
+        return false;
+    }
+    return true;
+}
+
+#if EK3_FEATURE_PARALLEL_CORES
+/*
+  a thread which runs UpdateFilter() for a single core each time it
+  is started. Not used in replay, where cores always run on the
+  calling thread
+ */
+class NavEKF3::CoreWorker {
+public:
+    CoreWorker(NavEKF3_core &_core, uint8_t _cpu_index) :
+        core(_core),
+        cpu_index(_cpu_index) {}
+
+    CLASS_NO_COPY(CoreWorker);
+
+    bool init(void);
+
+    // run the core update in the worker thread
+    void start(bool _allow_state_prediction) {
+        allow_state_prediction = _allow_state_prediction;
+        start_sem.signal();
+    }
+
+    // wait for the update started by start() to complete
+    void wait(void) {
+        done_sem.wait_blocking();
+    }
+
+private:
+    void thread(void);
+
+    NavEKF3_core &core;
+    const uint8_t cpu_index;
+    bool allow_state_prediction;
+    HAL_BinarySemaphore start_sem;
+    HAL_BinarySemaphore done_sem;
+};
+
+bool NavEKF3::CoreWorker::init(void)
+{
+#if EK3_CORE_WORKER_THREADS
+    return hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&NavEKF3::CoreWorker::thread, void),
+                                        "EKF3", 16384, AP_HAL::Scheduler::PRIORITY_MAIN, 0);
+#else
+    return false;
+#endif
+}
+
+void NavEKF3::CoreWorker::thread(void)
+{
+#if EK3_CORE_WORKER_THREADS
+    // spread the workers across CPUs. Worker i is pinned to CPU i,
+    // which does not keep it off the CPU the main thread runs on
+    hal.scheduler->set_thread_cpu(cpu_index);
+#endif
+    while (true) {
+        start_sem.wait_blocking();
+        core.UpdateFilter(allow_state_prediction);
+        done_sem.signal();
+    }
+}
+
+/*
+  start the worker thread for core i, creating it on first use.
+  Returns false if the core must be run on the calling thread
+ */
+bool NavEKF3::start_core_worker(uint8_t i, bool allow_state_prediction)
+{
+    if (core_worker_failed[i]) {
+        return false;
+    }
+    if (core_worker[i] == nullptr) {
+        core_worker[i] = new CoreWorker(core[i], i);
+        if (core_worker[i] == nullptr || !core_worker[i]->init()) {
+            // no thread, run this core on the calling thread from now on
+            delete core_worker[i];
+            core_worker[i] = nullptr;
+            core_worker_failed[i] = true;
+            return false;
+        }
+    }
+    core_worker[i]->start(allow_state_prediction);
+    return true;
+}
+
+/*
+  update all cores with cores 1..num_cores-1 running in worker
+  threads and core 0 on the calling thread.
+
+  The result must not depend on thread timing so that replay matches
+  the vehicle:
+   - each core has its own scratch space, see NAVEKF_CORE_SCRATCH
+   - the prediction allowance for every core is decided before any
+     core runs, as it depends on DAL timing state
+   - an origin set by a core, takeoff detection and core log messages
+     are only published after all cores have finished, in core index
+     order, on the calling thread
+ */
+void NavEKF3::UpdateFilterParallel(void)
+{
+    bool allow_state_prediction[MAX_EKF_CORES];
+    for (uint8_t i=0; i<num_cores; i++) {
+        allow_state_prediction[i] = allowStatePrediction(i);
+    }
+
+    defer_core_outputs = true;
+
+    bool threaded[MAX_EKF_CORES] {};
+    for (uint8_t i=1; i<num_cores; i++) {
+        threaded[i] = start_core_worker(i, allow_state_prediction[i]);
+    }
+    for (uint8_t i=0; i<num_cores; i++) {
+        if (!threaded[i]) {
+            core[i].UpdateFilter(allow_state_prediction[i]);
+        }
+    }
+    for (uint8_t i=1; i<num_cores; i++) {
+        if (threaded[i]) {
+            core_worker[i]->wait();
+        }
+    }
+
+    defer_core_outputs = false;
+
+    for (uint8_t i=0; i<num_cores; i++) {
+        core[i].publishDeferredOutputs();
+    }
+}
+#endif // EK3_FEATURE_PARALLEL_CORES
+
 /* 
   Update Filter States - this should be called whenever new IMU data is available
   Execution speed governed by SCHED_LOOP_RATE
@@ -906,17 +1068,15 @@ void NavEKF3::UpdateFilter(void)
 
     imuSampleTime_us = AP::dal().micros64();
 
-    for (uint8_t i=0; i<num_cores; i++) {
-        // if we have not overrun by more than 3 IMU frames, and we
-        // have already used more than 1/3 of the CPU budget for this
-        // loop then suppress the prediction step. This allows
-        // multiple EKF instances to cooperate on scheduling
-        bool allow_state_prediction = true;
-        if (core[i].getFramesSincePredict() < (_framesPerPrediction+3) &&
-            AP::dal().ekf_low_time_remaining(AP_DAL::EKFType::EKF3, i)) {
-            allow_state_prediction = false;
+#if EK3_FEATURE_PARALLEL_CORES
+    if (_coreThreads > 0 && num_cores > 1) {
+        UpdateFilterParallel();
+    } else
+#endif
+    {
+        for (uint8_t i=0; i<num_cores; i++) {
+            core[i].UpdateFilter(allowStatePrediction(i));
         }
-        core[i].UpdateFilter(allow_state_prediction);
     }
 
     // If the current core selected has a bad error score or is unhealthy, switch to a healthy core with the lowest fault score
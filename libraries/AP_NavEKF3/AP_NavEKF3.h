@@ -25,6 +25,8 @@
 #include <AP_NavEKF/AP_Nav_Common.h>
 #include <AP_NavEKF/AP_NavEKF_Source.h>
 
+#include "AP_NavEKF3_feature.h"
+
 class NavEKF3_core;
 class EKFGSF_yaw;
 
@@ -448,6 +450,7 @@ private:
     AP_Int8 _primary_core;          // initial core number
     AP_Enum<LogLevel> _log_level;   // log verbosity level
     AP_Float _gpsVAccThreshold;     // vertical accuracy threshold to use GPS as an altitude source
+    AP_Int8 _coreThreads;           // run cores 1..n-1 in worker threads when non-zero
 
 // Possible values for _flowUse
 #define FLOW_USE_NONE    0
@@ -529,9 +532,29 @@ private:
     float coreErrorScores[MAX_EKF_CORES];           // the instance error values used to update relative core error
     uint64_t coreLastTimePrimary_us[MAX_EKF_CORES]; // last time we were using this core as primary
 
+#if EK3_FEATURE_PARALLEL_CORES
+    // worker threads for cores 1..num_cores-1 when EK3_CORE_THREADS is set
+    class CoreWorker;
+    CoreWorker *core_worker[MAX_EKF_CORES] {};
+    bool core_worker_failed[MAX_EKF_CORES] {};
+
+    // run the cores in worker threads, waiting for all of them to finish
+    void UpdateFilterParallel(void);
+    bool start_core_worker(uint8_t i, bool allow_state_prediction);
+#endif
+
+    // true if core i may run its state prediction this frame
+    bool allowStatePrediction(uint8_t i);
+
     // origin set by one of the cores
     Location common_EKF_origin;
     bool common_origin_valid;
+
+    // when true cores hold back outputs that change state outside the
+    // core (a new origin, takeoff detection and log messages) and the
+    // frontend publishes them after all cores have run, in core index
+    // order
+    bool defer_core_outputs;
     
     // update the yaw reset data to capture changes due to a lane switch
     // new_primary - index of the ekf instance that we are about to switch to as the primary
@@ -661,14 +661,46 @@ bool NavEKF3_core::setOrigin(const Location &loc)
     validOrigin = true;
     GCS_SEND_TEXT(MAV_SEVERITY_INFO, "EKF3 IMU%u origin set",(unsigned)imu_index);
 
+    // when cores may be running concurrently the frontend publishes
+    // the origin once they have all finished
+    commonOriginPending = true;
+    if (!frontend->defer_core_outputs) {
+        updateCommonOrigin();
+    }
+
+    return true;
+}
+
+// offer our origin to the frontend if no core has set the common origin yet
+void NavEKF3_core::updateCommonOrigin(void)
+{
+    if (!commonOriginPending) {
+        return;
+    }
+    commonOriginPending = false;
     if (!frontend->common_origin_valid) {
         frontend->common_origin_valid = true;
         // put origin in frontend as well to ensure it stays in sync between lanes
         public_origin = EKF_origin;
     }
+}
+
+/*
+  publish the outputs held back while the frontend was deferring core
+  outputs, so they happen on the main thread and in core index order
+ */
+void NavEKF3_core::publishDeferredOutputs(void)
+{
+    updateCommonOrigin();
 
+    if (takeoffExpectedPending) {
+        takeoffExpectedPending = false;
+        dal.set_takeoff_expected();
+    }
 
-    return true;
+#if HAL_LOGGING_ENABLED
+    Log_Write_Deferred();
+#endif
 }
 
 // record a yaw reset event
@@ -445,4 +445,31 @@ void NavEKF3_core::Log_Write_GSF(uint64_t time_us)
     yawEstimator->Log_Write(time_us, LOG_XKY0_MSG, LOG_XKY1_MSG, DAL_CORE(core_index));
 }
 
+void NavEKF3_core::Log_Write_Deferrable(const void *pkt, uint8_t size)
+{
+    if (!frontend->defer_core_outputs) {
+        AP::logger().WriteBlock(pkt, size);
+        return;
+    }
+    if (deferredLogLen + size > sizeof(deferredLog)) {
+        // deferredLog holds one XKFM and one XKTV per update
+        return;
+    }
+    memcpy(&deferredLog[deferredLogLen], pkt, size);
+    deferredLogLen += size;
+}
+
+// write the messages held back by Log_Write_Deferrable()
+void NavEKF3_core::Log_Write_Deferred()
+{
+    // each message starts with its packet header, giving its type
+    uint8_t ofs = 0;
+    while (ofs + 3 <= deferredLogLen) {
+        const uint8_t size = deferredLog[ofs+2] == LOG_XKFM_MSG ? sizeof(log_XKFM) : sizeof(log_XKTV);
+        AP::logger().WriteBlock(&deferredLog[ofs], size);
+        ofs += size;
+    }
+    deferredLogLen = 0;
+}
+
 #endif  // HAL_LOGGING_ENABLED
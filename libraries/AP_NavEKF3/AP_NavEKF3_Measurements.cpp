@@ -1405,7 +1405,7 @@ void NavEKF3_core::updateMovementCheck(void)
             gyro_diff_ratio    : float(gyro_diff_ratio),
             accel_diff_ratio   : float(accel_diff_ratio),
         };
-        AP::logger().WriteBlock(&pkt, sizeof(pkt));
+        Log_Write_Deferrable(&pkt, sizeof(pkt));
 #endif
     }
 }
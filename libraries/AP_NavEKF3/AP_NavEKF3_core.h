@@ -126,6 +126,8 @@
 
 class NavEKF3_core : public NavEKF_core_common
 {
+    friend class NavEKF3_core_Test;
+
 public:
     // Constructor
     NavEKF3_core(class NavEKF3 *_frontend);
@@ -230,6 +232,14 @@ public:
     // returns false if Absolute aiding and GPS is being used or if the origin is already set
     bool setOriginLLH(const Location &loc);
 
+    // publish an origin set while the frontend was deferring core
+    // outputs
+    void updateCommonOrigin(void);
+
+    // publish all outputs held back while the frontend was deferring
+    // core outputs, called on the main thread
+    void publishDeferredOutputs(void);
+
     // Set the EKF's NE horizontal position states and their corresponding variances from a supplied WGS-84 location and uncertainty
     // The altitude element of the location is not used.
     // Returns true if the set was successful
@@ -1114,10 +1124,15 @@ private:
     bool needMagBodyVarReset;       // we need to reset mag body variances at next CovariancePrediction
     bool needEarthBodyVarReset;     // we need to reset mag earth variances at next CovariancePrediction
     bool inhibitDelAngBiasStates;   // true when IMU delta angle bias states are inactive
+#if EK3_FEATURE_SPARSE_COV_PREDICTION
+    bool denseCovPrediction;        // true to predict covariances of inhibited states too, used to test the sparse prediction
+#endif
     bool gpsIsInUse;                // bool true when GPS data is being used to correct states estimates
     Location EKF_origin;     // LLH origin of the NED axis system, internal only
     Location &public_origin; // LLH origin of the NED axis system, public functions
     bool validOrigin;               // true when the EKF origin is valid
+    bool commonOriginPending;       // true when EKF_origin has been set but not yet offered to the frontend
+    bool takeoffExpectedPending;    // true when launch was detected while core outputs were deferred
     ftype gpsSpdAccuracy;           // estimated speed accuracy in m/s returned by the GPS receiver
     ftype gpsPosAccuracy;           // estimated position accuracy in m returned by the GPS receiver
     ftype gpsHgtAccuracy;           // estimated height accuracy in m returned by the GPS receiver
@@ -1592,4 +1607,12 @@ private:
     void Log_Write_State_Variances(uint64_t time_us);
     void Log_Write_Timing(uint64_t time_us);
     void Log_Write_GSF(uint64_t time_us);
+
+    // write a log message from within the core update. While the
+    // frontend defers core outputs the message is held in deferredLog
+    // and written by publishDeferredOutputs()
+    void Log_Write_Deferrable(const void *pkt, uint8_t size);
+    void Log_Write_Deferred();
+    uint8_t deferredLog[64];
+    uint8_t deferredLogLen;
 };
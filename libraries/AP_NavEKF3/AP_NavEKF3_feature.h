@@ -10,7 +10,7 @@
 #include <AP_AHRS/AP_AHRS_config.h>
 
 // define for when to include all features
-#define EK3_FEATURE_ALL APM_BUILD_TYPE(APM_BUILD_AP_DAL_Standalone) || APM_BUILD_TYPE(APM_BUILD_Replay)
+#define EK3_FEATURE_ALL (APM_BUILD_TYPE(APM_BUILD_AP_DAL_Standalone) || APM_BUILD_TYPE(APM_BUILD_Replay))
 
 // body odomotry (which includes wheel encoding) on rover or 2M boards
 #ifndef EK3_FEATURE_BODY_ODOM
@@ -35,3 +35,14 @@
 #ifndef EK3_FEATURE_POSITION_RESET
 #define EK3_FEATURE_POSITION_RESET EK3_FEATURE_ALL || AP_AHRS_POSITION_RESET_ENABLED
 #endif
+
+// running cores 1..n-1 in worker threads on boards with multiple CPUs
+#ifndef EK3_FEATURE_PARALLEL_CORES
+#define EK3_FEATURE_PARALLEL_CORES (EK3_FEATURE_ALL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL)
+#endif
+
+// skip covariance prediction of inhibited states. Set to 0 to build
+// Replay with the dense prediction for comparison
+#ifndef EK3_FEATURE_SPARSE_COV_PREDICTION
+#define EK3_FEATURE_SPARSE_COV_PREDICTION 1
+#endif
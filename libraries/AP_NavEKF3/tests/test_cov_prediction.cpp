@@ -0,0 +1,131 @@
+#include <AP_gtest.h>
+
+/*
+  check the sparse EKF3 covariance prediction, which skips the states
+  that are inhibited, gives exactly the same covariance matrix as the
+  dense prediction
+ */
+
+#include <AP_NavEKF3/AP_NavEKF3.h>
+#include <AP_NavEKF3/AP_NavEKF3_core.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX) && EK3_FEATURE_SPARSE_COV_PREDICTION
+
+// small deterministic generator so both cores see the same inputs
+static uint32_t rand_state;
+static ftype rand_float(ftype lim)
+{
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    return lim * (ftype(rand_state) / ftype(UINT32_MAX) * 2 - 1);
+}
+
+static Vector3F rand_vector(ftype lim)
+{
+    return Vector3F{rand_float(lim), rand_float(lim), rand_float(lim)};
+}
+
+class NavEKF3_core_Test
+{
+public:
+    NavEKF3_core_Test(NavEKF3 *frontend, bool dense, uint32_t seed, uint8_t inhibit_mask) :
+        core(new NavEKF3_core(frontend))
+    {
+        core->denseCovPrediction = dense;
+        core->dtEkfAvg = EKF_TARGET_DT;
+        core->inhibitDelAngBiasStates = inhibit_mask & 1;
+        core->inhibitDelVelBiasStates = inhibit_mask & 2;
+        core->inhibitMagStates = inhibit_mask & 4;
+        core->lastInhibitMagStates = core->inhibitMagStates;
+        core->inhibitWindStates = inhibit_mask & 8;
+        core->updateStateIndexLim();
+
+        rand_state = seed;
+        core->stateStruct.quat.from_euler(rand_float(M_PI), rand_float(0.5), rand_float(0.5));
+        core->stateStruct.velocity = rand_vector(10);
+        core->stateStruct.gyro_bias = rand_vector(0.001);
+        core->stateStruct.accel_bias = rand_vector(0.01);
+        core->stateStruct.earth_magfield = rand_vector(0.5);
+        core->stateStruct.body_magfield = rand_vector(0.05);
+
+        // a random positive definite matrix with the inhibited
+        // partitions zeroed as ConstrainVariances() leaves them
+        NavEKF3_core::Matrix24 L {};
+        for (uint8_t i=0; i<24; i++) {
+            for (uint8_t j=0; j<=i; j++) {
+                L[i][j] = rand_float(0.01);
+            }
+            L[i][i] = 0.02 + fabsF(L[i][i]);
+        }
+        for (uint8_t i=0; i<24; i++) {
+            for (uint8_t j=0; j<24; j++) {
+                ftype sum = 0;
+                for (uint8_t k=0; k<=MIN(i, j); k++) {
+                    sum += L[i][k] * L[j][k];
+                }
+                core->P[i][j] = sum;
+            }
+        }
+        core->ConstrainVariances();
+    }
+
+    ~NavEKF3_core_Test()
+    {
+        delete core;
+    }
+
+    void predict(uint32_t seed)
+    {
+        rand_state = seed;
+        core->imuDataDelayed.delAng = rand_vector(0.01);
+        core->imuDataDelayed.delVel = rand_vector(0.05) + Vector3F{0, 0, -GRAVITY_MSS * EKF_TARGET_DT};
+        core->imuDataDelayed.delAngDT = EKF_TARGET_DT;
+        core->imuDataDelayed.delVelDT = EKF_TARGET_DT;
+        core->CovariancePrediction(nullptr);
+    }
+
+    const NavEKF3_core::Matrix24 &P() const
+    {
+        return core->P;
+    }
+
+private:
+    NavEKF3_core *core;
+};
+
+TEST(EKF3CovariancePrediction, SparseMatchesDense)
+{
+    NavEKF3 *frontend = new NavEKF3();
+
+    // every combination of inhibited delta angle bias, delta velocity
+    // bias, magnetic field and wind states
+    for (uint8_t inhibit_mask=0; inhibit_mask<16; inhibit_mask++) {
+        const uint32_t seed = 0x5eed0000 + inhibit_mask;
+        NavEKF3_core_Test sparse(frontend, false, seed, inhibit_mask);
+        NavEKF3_core_Test dense(frontend, true, seed, inhibit_mask);
+
+        for (uint32_t step=0; step<50; step++) {
+            sparse.predict(seed + 1 + step);
+            dense.predict(seed + 1 + step);
+
+            uint32_t differences = 0;
+            for (uint8_t i=0; i<24; i++) {
+                for (uint8_t j=0; j<24; j++) {
+                    if (sparse.P()[i][j] != dense.P()[i][j]) {
+                        differences++;
+                    }
+                }
+            }
+            EXPECT_EQ(differences, 0U) << "inhibit mask " << unsigned(inhibit_mask) << " step " << step;
+        }
+    }
+
+    delete frontend;
+}
+
+#endif
+
+AP_GTEST_MAIN()
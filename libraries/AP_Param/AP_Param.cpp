@@ -24,6 +24,7 @@
 #include "AP_Param.h"
 
 #include <cmath>
+#include <ctype.h>
 #include <string.h>
 
 #include <AP_Common/AP_Common.h>
@@ -47,6 +48,16 @@ extern const AP_HAL::HAL &hal;
 
 uint16_t AP_Param::sentinal_offset;
 
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+// index of parameter offsets in storage
+AP_Param::StorageIndexEntry *AP_Param::_storage_index;
+uint16_t AP_Param::_storage_index_count;
+uint16_t AP_Param::_storage_index_space;
+uint16_t AP_Param::_storage_index_sentinal;
+bool AP_Param::_storage_index_valid;
+HAL_Semaphore AP_Param::_storage_index_sem;
+#endif
+
 // singleton instance
 AP_Param *AP_Param::_singleton;
 
@@ -104,6 +115,14 @@ uint16_t AP_Param::_count_marker;
 uint16_t AP_Param::_count_marker_done;
 HAL_Semaphore AP_Param::_count_sem;
 
+#if AP_PARAM_NAME_INDEX_ENABLED
+// hashed parameter name index
+AP_Param::NameIndexEntry *AP_Param::_name_index;
+uint16_t AP_Param::_name_index_count;
+uint16_t AP_Param::_name_index_marker;
+HAL_Semaphore AP_Param::_name_index_sem;
+#endif
+
 // storage and naming information about all types that can be saved
 const AP_Param::Info *AP_Param::_var_info;
 
@@ -184,6 +203,10 @@ void AP_Param::erase_all(void)
 
     // add a sentinal directly after the header
     write_sentinal(sizeof(struct EEPROM_header));
+
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+    invalidate_storage_index();
+#endif
 }
 
 /* the 'group_id' of a element of a group is the 18 bit identifier
@@ -371,6 +394,9 @@ bool AP_Param::setup(void)
             _storage.copy_area(_storage_bak)) {
             // restored from backup
             INTERNAL_ERROR(AP_InternalError::error_t::params_restored);
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+            invalidate_storage_index();
+#endif
             return true;
         }
 #endif // AP_PARAM_STORAGE_BAK_ENABLED
@@ -754,6 +780,27 @@ bool AP_Param::is_sentinal(const Param_header &phdr)
 // if the sentinal isn't found either, the offset is set to 0xFFFF
 bool AP_Param::scan(const AP_Param::Param_header *target, uint16_t *pofs)
 {
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+    {
+        WITH_SEMAPHORE(_storage_index_sem);
+        if (build_storage_index()) {
+            const uint32_t id = storage_index_id(*target);
+            const uint16_t i = storage_index_lower_bound(id);
+            if (i < _storage_index_count && _storage_index[i].id == id) {
+                *pofs = _storage_index[i].ofs;
+                return true;
+            }
+            *pofs = _storage_index_sentinal;
+            if (_storage_index_sentinal == 0xffff) {
+                Debug("scan past end of eeprom");
+            } else {
+                sentinal_offset = _storage_index_sentinal;
+            }
+            return false;
+        }
+    }
+#endif
+
     struct Param_header phdr;
     uint16_t ofs = sizeof(AP_Param::EEPROM_header);
     while (ofs < _storage.size()) {
@@ -778,6 +825,97 @@ bool AP_Param::scan(const AP_Param::Param_header *target, uint16_t *pofs)
     return false;
 }
 
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+/*
+  the storage index is sorted on key, group element and type, which
+  together fill a 32 bit id
+ */
+uint32_t AP_Param::storage_index_id(const Param_header &phdr)
+{
+    return (uint32_t(get_key(phdr)) << 23) | (uint32_t(phdr.group_element) << 5) | phdr.type;
+}
+
+// return index of the first entry with an id not less than id
+uint16_t AP_Param::storage_index_lower_bound(uint32_t id)
+{
+    uint16_t lo = 0, hi = _storage_index_count;
+    while (lo < hi) {
+        const uint16_t mid = (lo + hi) / 2;
+        if (_storage_index[mid].id < id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/*
+  add a newly written parameter to the storage index. Only the first
+  copy of a parameter in storage is indexed, matching a linear
+  scan. Returns false if the index could not be grown
+ */
+bool AP_Param::storage_index_add(const Param_header &phdr, uint16_t ofs)
+{
+    const uint32_t id = storage_index_id(phdr);
+    const uint16_t i = storage_index_lower_bound(id);
+    if (i < _storage_index_count && _storage_index[i].id == id) {
+        return true;
+    }
+    if (_storage_index_count == _storage_index_space) {
+        const uint16_t new_space = _storage_index_space + 32;
+        void *new_index = hal.util->std_realloc(_storage_index, new_space * sizeof(StorageIndexEntry));
+        if (new_index == nullptr) {
+            // fall back to scanning storage
+            _storage_index_valid = false;
+            return false;
+        }
+        _storage_index = (StorageIndexEntry *)new_index;
+        _storage_index_space = new_space;
+    }
+    memmove(&_storage_index[i+1], &_storage_index[i], (_storage_index_count - i) * sizeof(StorageIndexEntry));
+    _storage_index[i].id = id;
+    _storage_index[i].ofs = ofs;
+    _storage_index_count++;
+    return true;
+}
+
+/*
+  build the storage index with a single walk of storage, if it is not
+  already valid. Must be called with _storage_index_sem held
+ */
+bool AP_Param::build_storage_index(void)
+{
+    if (_storage_index_valid) {
+        return true;
+    }
+    _storage_index_count = 0;
+    _storage_index_sentinal = 0xffff;
+
+    struct Param_header phdr;
+    uint16_t ofs = sizeof(AP_Param::EEPROM_header);
+    while (ofs < _storage.size()) {
+        _storage.read_block(&phdr, ofs, sizeof(phdr));
+        if (is_sentinal(phdr)) {
+            _storage_index_sentinal = ofs;
+            break;
+        }
+        if (!storage_index_add(phdr, ofs)) {
+            return false;
+        }
+        ofs += type_size((enum ap_var_type)phdr.type) + sizeof(phdr);
+    }
+    _storage_index_valid = true;
+    return true;
+}
+
+void AP_Param::invalidate_storage_index(void)
+{
+    WITH_SEMAPHORE(_storage_index_sem);
+    _storage_index_valid = false;
+}
+#endif // AP_PARAM_STORAGE_INDEX_ENABLED
+
 /**
  * add a _X, _Y, _Z suffix to the name of a Vector3f element
  * @param buffer
@@ -968,6 +1106,15 @@ AP_Param::find_by_index(uint16_t idx, enum ap_var_type *ptype, ParamToken *token
 // by-name equivalent of find_by_index()
 AP_Param* AP_Param::find_by_name(const char* name, enum ap_var_type *ptype, ParamToken *token)
 {
+#if AP_PARAM_NAME_INDEX_ENABLED
+    {
+        WITH_SEMAPHORE(_name_index_sem);
+        if (build_name_index()) {
+            return find_by_name_indexed(name, ptype, token);
+        }
+    }
+#endif
+
     AP_Param *ap;
     for (ap = AP_Param::first(token, ptype);
          ap && *ptype != AP_PARAM_GROUP && *ptype != AP_PARAM_NONE;
@@ -984,6 +1131,113 @@ AP_Param* AP_Param::find_by_name(const char* name, enum ap_var_type *ptype, Para
     return ap;
 }
 
+#if AP_PARAM_NAME_INDEX_ENABLED
+/*
+  case insensitive FNV-1a hash of a parameter name, truncated to fit
+  in a NameIndexEntry
+ */
+uint32_t AP_Param::name_hash(const char *name)
+{
+    uint32_t hash = 2166136261U;
+    for (uint8_t i=0; i<AP_MAX_NAME_SIZE && name[i] != 0; i++) {
+        hash ^= uint8_t(toupper(name[i]));
+        hash *= 16777619U;
+    }
+    return hash & 0x0FFFFFFFU;
+}
+
+int AP_Param::name_index_compare(const void *v1, const void *v2)
+{
+    const uint32_t h1 = ((const NameIndexEntry *)v1)->hash;
+    const uint32_t h2 = ((const NameIndexEntry *)v2)->hash;
+    if (h1 < h2) {
+        return -1;
+    }
+    return h1 > h2 ? 1 : 0;
+}
+
+/*
+  (re)build the name index if the set of parameters has changed since
+  it was last built. Must be called with _name_index_sem held. Returns
+  false if the index is not available
+ */
+bool AP_Param::build_name_index(void)
+{
+    const uint16_t marker = _count_marker;
+    if (_name_index != nullptr && _name_index_marker == marker) {
+        return true;
+    }
+    if (_num_vars == 0) {
+        return false;
+    }
+
+    const uint16_t count = count_parameters();
+    if (count != _name_index_count || _name_index == nullptr) {
+        free(_name_index);
+        _name_index_count = 0;
+        _name_index = (NameIndexEntry *)calloc(count, sizeof(NameIndexEntry));
+        if (_name_index == nullptr) {
+            return false;
+        }
+    }
+
+    ParamToken token {};
+    enum ap_var_type type;
+    uint16_t n = 0;
+    for (AP_Param *ap = first(&token, &type);
+         ap != nullptr && n < count;
+         ap = next_scalar(&token, &type)) {
+        if (type == AP_PARAM_GROUP || type == AP_PARAM_NONE) {
+            break;
+        }
+        char name[AP_MAX_NAME_SIZE+1] {};
+        ap->copy_name_token(token, name, AP_MAX_NAME_SIZE);
+        auto &e = _name_index[n++];
+        e.hash = name_hash(name);
+        e.type = type;
+        e.token = token;
+        e.ap = ap;
+    }
+    qsort(_name_index, n, sizeof(NameIndexEntry), name_index_compare);
+
+    _name_index_count = n;
+    _name_index_marker = marker;
+    return true;
+}
+
+/*
+  find_by_name() using the name index. Entries with a matching hash
+  are checked against the full name to resolve collisions
+ */
+AP_Param *AP_Param::find_by_name_indexed(const char *name, enum ap_var_type *ptype, ParamToken *token)
+{
+    const uint32_t hash = name_hash(name);
+
+    // find the first entry with this hash
+    uint16_t lo = 0, hi = _name_index_count;
+    while (lo < hi) {
+        const uint16_t mid = (lo + hi) / 2;
+        if (_name_index[mid].hash < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    for (uint16_t i=lo; i<_name_index_count && _name_index[i].hash == hash; i++) {
+        const auto &e = _name_index[i];
+        char buf[AP_MAX_NAME_SIZE];
+        e.ap->copy_name_token(e.token, buf, AP_MAX_NAME_SIZE);
+        if (strncasecmp(name, buf, AP_MAX_NAME_SIZE) == 0) {
+            *token = e.token;
+            *ptype = (enum ap_var_type)e.type;
+            return e.ap;
+        }
+    }
+    return nullptr;
+}
+#endif // AP_PARAM_NAME_INDEX_ENABLED
+
 /*
   Find a variable by pointer, returning key. This is used for loading pointer variables
 */
@@ -1233,6 +1487,15 @@ void AP_Param::save_sync(bool force_save, bool send_to_gcs)
     eeprom_write_check(ap, ofs+sizeof(phdr), type_size((enum ap_var_type)phdr.type));
     eeprom_write_check(&phdr, ofs, sizeof(phdr));
 
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+    {
+        WITH_SEMAPHORE(_storage_index_sem);
+        if (_storage_index_valid && storage_index_add(phdr, ofs)) {
+            _storage_index_sentinal = sentinal_offset;
+        }
+    }
+#endif
+
     if (send_to_gcs) {
         send_parameter(name, (enum ap_var_type)phdr.type, idx);
     }
@@ -1283,6 +1546,10 @@ void AP_Param::save_io_handler(void)
     if (hal.scheduler->is_system_initialized()) {
         // pay the cost of parameter counting in the IO thread
         count_parameters();
+#if AP_PARAM_NAME_INDEX_ENABLED
+        WITH_SEMAPHORE(_name_index_sem);
+        build_name_index();
+#endif
     }
 }
 
@@ -712,6 +712,29 @@ private:
                                     const struct GroupInfo *group_info,
                                     enum ap_var_type *ptype);
     static void                 write_sentinal(uint16_t ofs);
+
+#if AP_PARAM_STORAGE_INDEX_ENABLED
+    /*
+      index of the parameters in _storage, sorted by header id, so
+      scan() doesn't need to walk storage from the start
+     */
+    struct PACKED StorageIndexEntry {
+        uint32_t id;
+        uint16_t ofs;
+    };
+    static StorageIndexEntry *  _storage_index;
+    static uint16_t             _storage_index_count;
+    static uint16_t             _storage_index_space;
+    static uint16_t             _storage_index_sentinal;
+    static bool                 _storage_index_valid;
+    static HAL_Semaphore        _storage_index_sem;
+
+    static uint32_t             storage_index_id(const Param_header &phdr);
+    static bool                 build_storage_index(void);
+    static uint16_t             storage_index_lower_bound(uint32_t id);
+    static bool                 storage_index_add(const Param_header &phdr, uint16_t ofs);
+    static void                 invalidate_storage_index(void);
+#endif
     static uint16_t             get_key(const Param_header &phdr);
     static void                 set_key(Param_header &phdr, uint16_t key);
     static bool                 is_sentinal(const Param_header &phrd);
@@ -779,6 +802,28 @@ private:
     static HAL_Semaphore        _count_sem;
     static const struct Info *  _var_info;
 
+#if AP_PARAM_NAME_INDEX_ENABLED
+    /*
+      name index for find_by_name(), sorted by hash of the parameter
+      name. It is rebuilt whenever the parameter count is invalidated
+     */
+    struct NameIndexEntry {
+        uint32_t hash : 28;
+        uint32_t type : 4;
+        ParamToken token;
+        AP_Param *ap;
+    };
+    static NameIndexEntry *     _name_index;
+    static uint16_t             _name_index_count;
+    static uint16_t             _name_index_marker;
+    static HAL_Semaphore        _name_index_sem;
+
+    static uint32_t name_hash(const char *name);
+    static int name_index_compare(const void *v1, const void *v2);
+    static bool build_name_index(void);
+    static AP_Param *find_by_name_indexed(const char *name, enum ap_var_type *ptype, ParamToken *token);
+#endif
+
 #if AP_PARAM_DYNAMIC_ENABLED
     // allow for a dynamically allocated var table
     static uint16_t             _num_vars_base;
@@ -11,3 +11,13 @@
 #ifndef FORCE_APJ_DEFAULT_PARAMETERS
 #define FORCE_APJ_DEFAULT_PARAMETERS 0
 #endif
+
+// keep a hashed name index of all scalar parameters for find_by_name()
+#ifndef AP_PARAM_NAME_INDEX_ENABLED
+#define AP_PARAM_NAME_INDEX_ENABLED (HAL_MEM_CLASS >= HAL_MEM_CLASS_500)
+#endif
+
+// keep an in-memory index of parameter offsets in storage for scan()
+#ifndef AP_PARAM_STORAGE_INDEX_ENABLED
+#define AP_PARAM_STORAGE_INDEX_ENABLED (HAL_MEM_CLASS >= HAL_MEM_CLASS_500)
+#endif
@@ -115,10 +115,13 @@ bool AP_RCProtocol::should_search(uint32_t now_ms) const
     return (now_ms - _last_input_ms >= 200);
 }
 
-void AP_RCProtocol::process_pulse(uint32_t width_s0, uint32_t width_s1)
+/*
+  common handling at the start of new input. Returns true if we are
+  searching for a protocol
+ */
+bool AP_RCProtocol::start_input(uint32_t now_ms)
 {
-    uint32_t now = AP_HAL::millis();
-    bool searching = should_search(now);
+    const bool searching = should_search(now_ms);
 
 #if AP_RC_CHANNEL_ENABLED
     rc_protocols_mask = rc().enabled_protocols();
@@ -128,52 +131,99 @@ void AP_RCProtocol::process_pulse(uint32_t width_s0, uint32_t width_s1)
         !protocol_enabled(_detected_protocol)) {
         _detected_protocol = AP_RCProtocol::NONE;
     }
-    
+    return searching;
+}
+
+/*
+  return the mask of backends which could decode pulses, or bytes at
+  baudrate, while searching for a protocol. This is worked out once per
+  batch of input rather than once per pulse or byte
+ */
+uint32_t AP_RCProtocol::search_mask(bool pulses, uint32_t baudrate) const
+{
+    uint32_t mask = 0;
+    for (uint8_t i = 0; i < ARRAY_SIZE(backend); i++) {
+        if (backend[i] == nullptr || !protocol_enabled(rcprotocol_t(i))) {
+            continue;
+        }
+        if (pulses && (_disabled_for_pulses & (1U << i))) {
+            // this protocol is disabled for pulse input
+            continue;
+        }
+        if (!pulses && !backend[i]->accepts_baudrate(baudrate)) {
+            continue;
+        }
+        mask |= 1U << i;
+    }
+    return mask;
+}
+
+/*
+  called after passing input to a backend while searching. If the
+  backend decoded enough frames then lock onto its protocol and
+  return true
+ */
+bool AP_RCProtocol::lock_protocol(rcprotocol_t protocol, uint32_t frame_count, uint32_t input_count, uint32_t now_ms, bool with_bytes)
+{
+    const uint32_t frame_count2 = backend[protocol]->get_rc_frame_count();
+    if (frame_count2 <= frame_count) {
+        return false;
+    }
+    if (requires_3_frames(protocol) && frame_count2 < 3) {
+        return false;
+    }
+    _new_input = (input_count != backend[protocol]->get_rc_input_count());
+    _detected_protocol = protocol;
+    for (uint8_t j = 0; j < ARRAY_SIZE(backend); j++) {
+        if (backend[j]) {
+            backend[j]->reset_rc_frame_count();
+        }
+    }
+    _last_input_ms = now_ms;
+    _detected_with_bytes = with_bytes;
+    return true;
+}
+
+void AP_RCProtocol::process_pulse(uint32_t width_s0, uint32_t width_s1)
+{
+    const uint32_t now = AP_HAL::millis();
+    const bool searching = start_input(now);
+    _process_pulse(width_s0, width_s1, now, searching, searching ? search_mask(true, 0) : 0);
+}
+
+/*
+  process one pulse pair, scanning the backends in mask if we are
+  searching. Returns false if we are still searching
+ */
+bool AP_RCProtocol::_process_pulse(uint32_t width_s0, uint32_t width_s1, uint32_t now_ms, bool searching, uint32_t mask)
+{
     if (_detected_protocol != AP_RCProtocol::NONE && _detected_with_bytes && !searching) {
         // we're using byte inputs, discard pulses
-        return;
+        return true;
     }
     // first try current protocol
     if (_detected_protocol != AP_RCProtocol::NONE && !searching) {
         backend[_detected_protocol]->process_pulse(width_s0, width_s1);
         if (backend[_detected_protocol]->new_input()) {
             _new_input = true;
-            _last_input_ms = now;
+            _last_input_ms = now_ms;
         }
-        return;
+        return true;
     }
 
     // otherwise scan all protocols
     for (uint8_t i = 0; i < ARRAY_SIZE(backend); i++) {
-        if (_disabled_for_pulses & (1U << i)) {
-            // this protocol is disabled for pulse input
+        if (!(mask & (1U << i))) {
             continue;
         }
-        if (backend[i] != nullptr) {
-            if (!protocol_enabled(rcprotocol_t(i))) {
-                continue;
-            }
-            const uint32_t frame_count = backend[i]->get_rc_frame_count();
-            const uint32_t input_count = backend[i]->get_rc_input_count();
-            backend[i]->process_pulse(width_s0, width_s1);
-            const uint32_t frame_count2 = backend[i]->get_rc_frame_count();
-            if (frame_count2 > frame_count) {
-                if (requires_3_frames((rcprotocol_t)i) && frame_count2 < 3) {
-                    continue;
-                }
-                _new_input = (input_count != backend[i]->get_rc_input_count());
-                _detected_protocol = (enum AP_RCProtocol::rcprotocol_t)i;
-                for (uint8_t j = 0; j < ARRAY_SIZE(backend); j++) {
-                    if (backend[j]) {
-                        backend[j]->reset_rc_frame_count();
-                    }
-                }
-                _last_input_ms = now;
-                _detected_with_bytes = false;
-                break;
-            }
+        const uint32_t frame_count = backend[i]->get_rc_frame_count();
+        const uint32_t input_count = backend[i]->get_rc_input_count();
+        backend[i]->process_pulse(width_s0, width_s1);
+        if (lock_protocol(rcprotocol_t(i), frame_count, input_count, now_ms, false)) {
+            return true;
         }
     }
+    return false;
 }
 
 /*
@@ -184,6 +234,9 @@ void AP_RCProtocol::process_pulse_list(const uint32_t *widths, uint16_t n, bool
     if (n & 1) {
         return;
     }
+    const uint32_t now = AP_HAL::millis();
+    bool searching = start_input(now);
+    const uint32_t mask = searching ? search_mask(true, 0) : 0;
     while (n) {
         uint32_t widths0 = widths[0];
         uint32_t widths1 = widths[1];
@@ -193,7 +246,10 @@ void AP_RCProtocol::process_pulse_list(const uint32_t *widths, uint16_t n, bool
             widths0 = tmp;
         }
         widths1 -= widths0;
-        process_pulse(widths0, widths1);
+        if (_process_pulse(widths0, widths1, now, searching, mask)) {
+            // the rest of the list goes to the detected protocol
+            searching = false;
+        }
         widths += 2;
         n -= 2;
     }
@@ -201,63 +257,64 @@ void AP_RCProtocol::process_pulse_list(const uint32_t *widths, uint16_t n, bool
 
 bool AP_RCProtocol::process_byte(uint8_t byte, uint32_t baudrate)
 {
-    uint32_t now = AP_HAL::millis();
-    bool searching = should_search(now);
-
-#if AP_RC_CHANNEL_ENABLED
-    rc_protocols_mask = rc().enabled_protocols();
-#endif
+    return process_bytes(&byte, 1, baudrate);
+}
 
-    if (_detected_protocol != AP_RCProtocol::NONE &&
-        !protocol_enabled(_detected_protocol)) {
-        _detected_protocol = AP_RCProtocol::NONE;
-    }
+/*
+  process a buffer of bytes, such as a DMA buffer from a uart. While
+  searching, each byte is only passed to the backends which accept the
+  baudrate and whose framing could use the byte
+ */
+bool AP_RCProtocol::process_bytes(const uint8_t *bytes, uint16_t n, uint32_t baudrate)
+{
+    const uint32_t now = AP_HAL::millis();
+    const bool searching = start_input(now);
 
     if (_detected_protocol != AP_RCProtocol::NONE && !_detected_with_bytes && !searching) {
         // we're using pulse inputs, discard bytes
         return false;
     }
 
-    // first try current protocol
-    if (_detected_protocol != AP_RCProtocol::NONE && !searching) {
-        backend[_detected_protocol]->process_byte(byte, baudrate);
-        if (backend[_detected_protocol]->new_input()) {
-            _new_input = true;
-            _last_input_ms = now;
-        }
-        return true;
-    }
-
-    // otherwise scan all protocols
-    for (uint8_t i = 0; i < ARRAY_SIZE(backend); i++) {
-        if (backend[i] != nullptr) {
-            if (!protocol_enabled(rcprotocol_t(i))) {
-                continue;
-            }
-            const uint32_t frame_count = backend[i]->get_rc_frame_count();
-            const uint32_t input_count = backend[i]->get_rc_input_count();
-            backend[i]->process_byte(byte, baudrate);
-            const uint32_t frame_count2 = backend[i]->get_rc_frame_count();
-            if (frame_count2 > frame_count) {
-                if (requires_3_frames((rcprotocol_t)i) && frame_count2 < 3) {
+    uint16_t ofs = 0;
+    if (_detected_protocol == AP_RCProtocol::NONE || searching) {
+        // scan all protocols
+        const uint32_t mask = search_mask(false, baudrate);
+        bool detected = false;
+        while (ofs < n && !detected) {
+            const uint8_t b = bytes[ofs++];
+            for (uint8_t i = 0; i < ARRAY_SIZE(backend); i++) {
+                if (!(mask & (1U << i)) || backend[i]->can_skip_byte(b)) {
                     continue;
                 }
-                _new_input = (input_count != backend[i]->get_rc_input_count());
-                _detected_protocol = (enum AP_RCProtocol::rcprotocol_t)i;
-                _last_input_ms = now;
-                _detected_with_bytes = true;
-                for (uint8_t j = 0; j < ARRAY_SIZE(backend); j++) {
-                    if (backend[j]) {
-                        backend[j]->reset_rc_frame_count();
-                    }
+                const uint32_t frame_count = backend[i]->get_rc_frame_count();
+                const uint32_t input_count = backend[i]->get_rc_input_count();
+                backend[i]->process_byte(b, baudrate);
+                if (lock_protocol(rcprotocol_t(i), frame_count, input_count, now, true)) {
+                    // stop decoding pulses to save CPU
+                    hal.rcin->pulse_input_enable(false);
+                    detected = true;
+                    break;
                 }
-                // stop decoding pulses to save CPU
-                hal.rcin->pulse_input_enable(false);
-                return true;
             }
         }
+        if (!detected) {
+            return false;
+        }
+        if (ofs == n) {
+            return true;
+        }
     }
-    return false;
+
+    // the rest of the buffer goes to the current protocol
+    AP_RCProtocol_Backend *p = backend[_detected_protocol];
+    for (; ofs < n; ofs++) {
+        p->process_byte(bytes[ofs], baudrate);
+    }
+    if (p->new_input()) {
+        _new_input = true;
+        _last_input_ms = now;
+    }
+    return true;
 }
 
 // handshake if nothing else has succeeded so far
@@ -335,12 +392,16 @@ void AP_RCProtocol::check_added_uart(void)
     const uint32_t current_baud = serial_configs[added.config_num].baud;
     process_handshake(current_baud);
 
-    uint32_t n = added.uart->available();
-    n = MIN(n, 255U);
-    for (uint8_t i=0; i<n; i++) {
-        int16_t b = added.uart->read();
-        if (b >= 0) {
-            process_byte(uint8_t(b), current_baud);
+    // take up to 256 bytes per call, a buffer at a time
+    uint8_t buf[64];
+    for (uint8_t i=0; i<4; i++) {
+        const ssize_t n = added.uart->read(buf, sizeof(buf));
+        if (n <= 0) {
+            break;
+        }
+        process_bytes(buf, n, current_baud);
+        if (n < ssize_t(sizeof(buf))) {
+            break;
         }
     }
     if (searching) {
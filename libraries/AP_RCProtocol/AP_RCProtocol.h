@@ -96,6 +96,8 @@ public:
     void process_pulse(uint32_t width_s0, uint32_t width_s1);
     void process_pulse_list(const uint32_t *widths, uint16_t n, bool need_swap);
     bool process_byte(uint8_t byte, uint32_t baudrate);
+    // process a buffer of bytes received at baudrate
+    bool process_bytes(const uint8_t *bytes, uint16_t n, uint32_t baudrate);
     void process_handshake(uint32_t baudrate);
     void update(void);
 
@@ -211,6 +213,12 @@ private:
     // return true if a specific protocol is enabled
     bool protocol_enabled(enum rcprotocol_t protocol) const;
 
+    // input handling common to pulses and bytes
+    bool start_input(uint32_t now_ms);
+    uint32_t search_mask(bool pulses, uint32_t baudrate) const;
+    bool lock_protocol(rcprotocol_t protocol, uint32_t frame_count, uint32_t input_count, uint32_t now_ms, bool with_bytes);
+    bool _process_pulse(uint32_t width_s0, uint32_t width_s1, uint32_t now_ms, bool searching, uint32_t mask);
+
     // explicitly investigate a backend for data, as opposed to
     // feeding the backend a byte (or pulse-train) at a time and
     // having them make an "add_input" callback):
@@ -32,6 +32,18 @@ public:
     virtual ~AP_RCProtocol_Backend() {}
     virtual void process_pulse(uint32_t width_s0, uint32_t width_s1) {}
     virtual void process_byte(uint8_t byte, uint32_t baudrate) {}
+
+    // return true if process_byte() can decode bytes at this
+    // baudrate. Bytes at other rates are not passed to the backend
+    virtual bool accepts_baudrate(uint32_t baudrate) const { return true; }
+
+    /*
+      return true if the backend is waiting for the start of a frame
+      and byte cannot start one, so process_byte() would discard it
+      without any change in state. This lets the frontend only pass
+      bytes that match a frame signature while searching for a protocol
+     */
+    virtual bool can_skip_byte(uint8_t byte) const { return false; }
     virtual void process_handshake(uint32_t baudrate) {}
     uint16_t read(uint8_t chan);
     void read(uint16_t *pwm, uint8_t n);
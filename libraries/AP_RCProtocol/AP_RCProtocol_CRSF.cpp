@@ -213,10 +213,15 @@ uint16_t AP_RCProtocol_CRSF::get_link_rate(ProtocolType protocol) const {
 }
 
 // process a byte provided by a uart from rc stack
-void AP_RCProtocol_CRSF::process_byte(uint8_t byte, uint32_t baudrate)
+bool AP_RCProtocol_CRSF::accepts_baudrate(uint32_t baudrate) const
 {
     // reject RC data if we have been configured for standalone mode
-    if ((baudrate != CRSF_BAUDRATE && baudrate != CRSF_BAUDRATE_1MBIT && baudrate != CRSF_BAUDRATE_2MBIT) || _uart) {
+    return (baudrate == CRSF_BAUDRATE || baudrate == CRSF_BAUDRATE_1MBIT || baudrate == CRSF_BAUDRATE_2MBIT) && _uart == nullptr;
+}
+
+void AP_RCProtocol_CRSF::process_byte(uint8_t byte, uint32_t baudrate)
+{
+    if (!accepts_baudrate(baudrate)) {
         return;
     }
     _process_byte(byte);
@@ -270,9 +275,10 @@ bool AP_RCProtocol_CRSF::check_frame(uint32_t timestamp_us)
         return false;
     }
 
-    // check validity of the length byte if we have received it
+    // check validity of the length byte if we have received it, the
+    // length covers at least the type and crc bytes
     if (_frame_ofs >= CRSF_HEADER_TYPE_LEN &&
-        _frame.length > CRSF_FRAME_PAYLOAD_MAX) {
+        (_frame.length < 2 || _frame.length > CRSF_FRAME_PAYLOAD_MAX)) {
         return false;
     }
 
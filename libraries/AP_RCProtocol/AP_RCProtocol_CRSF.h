@@ -41,6 +41,12 @@ public:
     AP_RCProtocol_CRSF(AP_RCProtocol &_frontend);
     virtual ~AP_RCProtocol_CRSF();
     void process_byte(uint8_t byte, uint32_t baudrate) override;
+    bool accepts_baudrate(uint32_t baudrate) const override;
+    // a frame that does not start with our address is dropped once
+    // the header is complete, so there is no need to buffer the byte
+    bool can_skip_byte(uint8_t byte) const override {
+        return _frame_ofs == 0 && byte != CRSF_ADDRESS_FLIGHT_CONTROLLER;
+    }
     void process_handshake(uint32_t baudrate) override;
     void update(void) override;
     // support for CRSF v3
@@ -32,6 +32,9 @@ public:
     AP_RCProtocol_DSM(AP_RCProtocol &_frontend) : AP_RCProtocol_Backend(_frontend) {}
     void process_pulse(uint32_t width_s0, uint32_t width_s1) override;
     void process_byte(uint8_t byte, uint32_t baudrate) override;
+    bool accepts_baudrate(uint32_t baudrate) const override {
+        return baudrate == 115200;
+    }
     void start_bind(void) override;
     void update(void) override;
 
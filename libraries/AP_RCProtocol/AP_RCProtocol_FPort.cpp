@@ -310,10 +310,19 @@ bool AP_RCProtocol_FPort::check_checksum(void)
     return crc_sum8_with_carry(&byte_input.buf[1], len) == 0x00;
 }
 
+/*
+  a byte other than the frame header is dropped at the start of a
+  frame, and a frame gap only resets a frame we are not in yet
+ */
+bool AP_RCProtocol_FPort::can_skip_byte(uint8_t b) const
+{
+    return byte_input.ofs == 0 && b != FRAME_HEAD;
+}
+
 // support byte input
 void AP_RCProtocol_FPort::process_byte(uint8_t b, uint32_t baudrate)
 {
-    if (baudrate != 115200) {
+    if (!accepts_baudrate(baudrate)) {
         return;
     }
     _process_byte(AP_HAL::micros(), b);
@@ -416,10 +416,15 @@ bool AP_RCProtocol_GHST::is_telemetry_supported() const
 }
 
 // process a byte provided by a uart
+bool AP_RCProtocol_GHST::accepts_baudrate(uint32_t baudrate) const
+{
+    return baudrate == CRSF_BAUDRATE || baudrate == GHST_BAUDRATE;
+}
+
 void AP_RCProtocol_GHST::process_byte(uint8_t byte, uint32_t baudrate)
 {
     // reject RC data if we have been configured for standalone mode
-    if (baudrate != CRSF_BAUDRATE && baudrate != GHST_BAUDRATE) {
+    if (!accepts_baudrate(baudrate)) {
         return;
     }
     _process_byte(AP_HAL::micros(), byte);
@@ -99,7 +99,7 @@ void AP_RCProtocol_IBUS::_process_byte(uint32_t timestamp_us, uint8_t b)
 // support byte input
 void AP_RCProtocol_IBUS::process_byte(uint8_t b, uint32_t baudrate)
 {
-    if (baudrate != 115200) {
+    if (!accepts_baudrate(baudrate)) {
         return;
     }
     _process_byte(AP_HAL::micros(), b);
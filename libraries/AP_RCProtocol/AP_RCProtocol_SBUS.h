@@ -29,6 +29,11 @@ public:
     AP_RCProtocol_SBUS(AP_RCProtocol &_frontend, bool inverted, uint32_t configured_baud);
     void process_pulse(uint32_t width_s0, uint32_t width_s1) override;
     void process_byte(uint8_t byte, uint32_t baudrate) override;
+    // note that if we're here we're not actually using SoftSerial,
+    // but it does record our configured baud rate:
+    bool accepts_baudrate(uint32_t baudrate) const override {
+        return baudrate == ss.baud();
+    }
 
     static bool sbus_decode(const uint8_t frame[25], uint16_t *values, uint16_t *num_values,
                             bool &sbus_failsafe, uint16_t max_values);
@@ -280,7 +280,7 @@ void AP_RCProtocol_SRXL::_process_byte(uint32_t timestamp_us, uint8_t byte)
  */
 void AP_RCProtocol_SRXL::process_byte(uint8_t byte, uint32_t baudrate)
 {
-    if (baudrate != 115200) {
+    if (!accepts_baudrate(baudrate)) {
         return;
     }
     _process_byte(AP_HAL::micros(), byte);
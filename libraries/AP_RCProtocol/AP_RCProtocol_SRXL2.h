@@ -31,6 +31,9 @@ public:
     AP_RCProtocol_SRXL2(AP_RCProtocol &_frontend);
     virtual ~AP_RCProtocol_SRXL2();
     void process_byte(uint8_t byte, uint32_t baudrate) override;
+    bool accepts_baudrate(uint32_t baudrate) const override {
+        return baudrate == 115200;
+    }
     void process_handshake(uint32_t baudrate) override;
     void start_bind(void) override;
     void update(void) override;
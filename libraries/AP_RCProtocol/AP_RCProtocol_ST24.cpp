@@ -234,7 +234,7 @@ void AP_RCProtocol_ST24::_process_byte(uint8_t byte)
 
 void AP_RCProtocol_ST24::process_byte(uint8_t byte, uint32_t baudrate)
 {
-    if (baudrate != 115200) {
+    if (!accepts_baudrate(baudrate)) {
         return;
     }
     _process_byte(byte);
@@ -45,6 +45,12 @@ public:
     AP_RCProtocol_ST24(AP_RCProtocol &_frontend) : AP_RCProtocol_Backend(_frontend) {}
     void process_pulse(uint32_t width_s0, uint32_t width_s1) override;
     void process_byte(uint8_t byte, uint32_t baudrate) override;
+    bool accepts_baudrate(uint32_t baudrate) const override {
+        return baudrate == 115200;
+    }
+    bool can_skip_byte(uint8_t byte) const override {
+        return _decode_state == ST24_DECODE_STATE_UNSYNCED && byte != ST24_STX1;
+    }
 private:
     void _process_byte(uint8_t byte);
     static uint8_t st24_crc8(uint8_t *ptr, uint8_t len);
@@ -67,6 +67,12 @@ void AP_RCProtocol_SUMD::process_pulse(uint32_t width_s0, uint32_t width_s1)
     }
 }
 
+// only a header byte can take us out of the unsynced state
+bool AP_RCProtocol_SUMD::can_skip_byte(uint8_t byte) const
+{
+    return _decode_state == SUMD_DECODE_STATE_UNSYNCED && byte != SUMD_HEADER_ID;
+}
+
 void AP_RCProtocol_SUMD::_process_byte(uint32_t timestamp_us, uint8_t byte)
 {
     if (timestamp_us - last_packet_us > 5000U) {
@@ -201,7 +207,7 @@ void AP_RCProtocol_SUMD::_process_byte(uint32_t timestamp_us, uint8_t byte)
 
 void AP_RCProtocol_SUMD::process_byte(uint8_t byte, uint32_t baudrate)
 {
-    if (baudrate != 115200) {
+    if (!accepts_baudrate(baudrate)) {
         return;
     }
     _process_byte(AP_HAL::micros(), byte);
@@ -31,6 +31,10 @@ public:
     AP_RCProtocol_SUMD(AP_RCProtocol &_frontend) : AP_RCProtocol_Backend(_frontend) {}
     void process_pulse(uint32_t width_s0, uint32_t width_s1) override;
     void process_byte(uint8_t byte, uint32_t baudrate) override;
+    bool accepts_baudrate(uint32_t baudrate) const override {
+        return baudrate == 115200;
+    }
+    bool can_skip_byte(uint8_t byte) const override;
 
 private:
     void _process_byte(uint32_t timestamp_us, uint8_t byte);
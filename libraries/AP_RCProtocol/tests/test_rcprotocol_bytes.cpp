@@ -0,0 +1,318 @@
+/*
+  test that skipping bytes with can_skip_byte() while searching for a
+  protocol decodes the same frames as passing every byte to the
+  backend, and that feeding a stream through process_bytes() in
+  batches detects the same protocol as feeding it a byte at a time
+ */
+#include <AP_gtest.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AP_RCProtocol/AP_RCProtocol.h>
+#include <AP_RCProtocol/AP_RCProtocol_CRSF.h>
+#include <AP_RCProtocol/AP_RCProtocol_FPort.h>
+#include <AP_RCProtocol/AP_RCProtocol_ST24.h>
+#include <AP_RCProtocol/AP_RCProtocol_SUMD.h>
+#include <RC_Channel/RC_Channel.h>
+#include <unistd.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+class RC_Channel_Test : public RC_Channel {};
+
+class RC_Channels_Test : public RC_Channels
+{
+public:
+    RC_Channel_Test obj_channels[NUM_RC_CHANNELS];
+
+    RC_Channel_Test *channel(const uint8_t chan) override {
+        if (chan >= NUM_RC_CHANNELS) {
+            return nullptr;
+        }
+        return &obj_channels[chan];
+    }
+
+protected:
+    int8_t flight_mode_channel_number() const override { return 5; }
+};
+
+#define RC_CHANNELS_SUBCLASS RC_Channels_Test
+#define RC_CHANNEL_SUBCLASS RC_Channel_Test
+
+#include <RC_Channel/RC_Channels_VarInfo.h>
+
+// backends log raw data and check failsafe options through rc()
+static RC_Channels_Test rchannels;
+
+/*
+  streams recorded from receivers, as used by the RCProtocolTest example
+ */
+static const uint8_t crsf_frame[] = {
+    0xC8, 0x14, 0x17, 0x20, 0x03, 0x0C, 0xA0, 0x00, 0xF6, 0xB7, 0x6E, 0x94, 0xFC,
+    0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFE, 0x0F, 0x6E
+};
+static const uint16_t crsf_output[] = {
+    1501, 1500, 989, 1497, 1873, 1136, 2011, 988, 988, 988, 988, 2011, 0, 0, 0, 0, 0, 0
+};
+
+static const uint8_t sumd_frame[] = {
+    0xA8, 0x01, 0x08, 0x2F, 0x50, 0x31, 0xE8, 0x21, 0xA0, 0x2F, 0x50, 0x22, 0x60,
+    0x22, 0x60, 0x2E, 0xE0, 0x2E, 0xE0, 0x87, 0xC6
+};
+static const uint16_t sumd_output[] = {
+    1597, 1076, 1514, 1514, 1100, 1100, 1500, 1500
+};
+
+static const uint8_t fport_frame[] = {
+    0x7E, 0x19, 0x00, 0xE7, 0x3B, 0xDF, 0x5A, 0xCE, 0x07, 0x10, 0x75, 0x49, 0x9C,
+    0x15, 0xE0, 0x03, 0x1F, 0xF8, 0xC0, 0x07, 0x3E, 0xF0, 0x81, 0x0F, 0x7C, 0x00,
+    0x38, 0xFA, 0x7E
+};
+static const uint16_t fport_output[] = {
+    1499, 1499, 1101, 1499, 1035, 1341, 2006, 982, 1495, 1495, 1495, 1495, 1495, 1495, 1495, 1495
+};
+
+/*
+  12 channel ST24 frame: raw values 2048, 2048, 0, 2048, 4095, 1024,
+  3072, 2048, 100, 4000, 2048, 2048
+ */
+static const uint8_t st24_frame[] = {
+    0x55, 0x55, 0x18, 0x00, 0x34, 0x12, 0x40, 0x01, 0x80, 0x08, 0x00, 0x00, 0x08,
+    0x00, 0xFF, 0xF4, 0x00, 0xC0, 0x08, 0x00, 0x06, 0x4F, 0xA0, 0x80, 0x08, 0x00,
+    0xC8
+};
+static const uint16_t st24_output[] = {
+    1499, 1499, 999, 1499, 1999, 1249, 1749, 1499, 1023, 1976, 1499, 1499
+};
+
+// bytes a receiver could send before a frame, including header values
+static const uint8_t noise[] = {
+    0x00, 0xFF, 0xC8, 0x55, 0x7E, 0xA8, 0x01, 0x13, 0x7D, 0x55, 0xEE
+};
+
+struct StreamTest {
+    const char *name;
+    AP_RCProtocol::rcprotocol_t protocol;
+    uint32_t baudrate;
+    // gap a receiver leaves between frames, needed by protocols which
+    // use the gap to find the start of a frame
+    uint16_t frame_gap_us;
+    const uint8_t *frame;
+    uint8_t frame_len;
+    const uint16_t *output;
+    uint8_t num_output;
+};
+
+static const StreamTest stream_tests[] = {
+    { "CRSF", AP_RCProtocol::CRSF, CRSF_BAUDRATE, 0, crsf_frame, sizeof(crsf_frame), crsf_output, ARRAY_SIZE(crsf_output) },
+    { "SUMD", AP_RCProtocol::SUMD, 115200, 0, sumd_frame, sizeof(sumd_frame), sumd_output, ARRAY_SIZE(sumd_output) },
+    { "ST24", AP_RCProtocol::ST24, 115200, 0, st24_frame, sizeof(st24_frame), st24_output, ARRAY_SIZE(st24_output) },
+    { "FPORT", AP_RCProtocol::FPORT, 115200, 3000, fport_frame, sizeof(fport_frame), fport_output, ARRAY_SIZE(fport_output) },
+};
+
+#define MAX_STREAM_LEN 512
+#define NUM_FRAMES 6
+
+/*
+  noise, then the tail of a frame, as if we started listening part
+  way through a frame, then NUM_FRAMES whole frames
+ */
+struct Stream {
+    uint8_t bytes[MAX_STREAM_LEN];
+    uint16_t len;
+    // offset of the start of each whole frame
+    uint16_t frame_ofs[NUM_FRAMES];
+};
+
+static void build_stream(const StreamTest &t, uint8_t noise_len, uint8_t start_ofs, Stream &s)
+{
+    s.len = 0;
+    memcpy(&s.bytes[s.len], noise, noise_len);
+    s.len += noise_len;
+    memcpy(&s.bytes[s.len], &t.frame[start_ofs], t.frame_len - start_ofs);
+    s.len += t.frame_len - start_ofs;
+    for (uint8_t i=0; i<NUM_FRAMES; i++) {
+        s.frame_ofs[i] = s.len;
+        memcpy(&s.bytes[s.len], t.frame, t.frame_len);
+        s.len += t.frame_len;
+    }
+}
+
+/*
+  return the length of the piece of stream starting at ofs which
+  arrives without a gap
+ */
+static uint16_t piece_len(const Stream &s, uint16_t ofs)
+{
+    for (uint8_t i=0; i<NUM_FRAMES; i++) {
+        if (s.frame_ofs[i] > ofs) {
+            return s.frame_ofs[i] - ofs;
+        }
+    }
+    return s.len - ofs;
+}
+
+static void frame_gap(const StreamTest &t, const Stream &s, uint16_t ofs)
+{
+    if (t.frame_gap_us == 0) {
+        return;
+    }
+    for (uint8_t i=0; i<NUM_FRAMES; i++) {
+        if (s.frame_ofs[i] == ofs) {
+            usleep(t.frame_gap_us);
+            return;
+        }
+    }
+}
+
+static AP_RCProtocol_Backend *new_backend(AP_RCProtocol &frontend, AP_RCProtocol::rcprotocol_t protocol)
+{
+    switch (protocol) {
+    case AP_RCProtocol::CRSF:
+        return new AP_RCProtocol_CRSF(frontend);
+    case AP_RCProtocol::SUMD:
+        return new AP_RCProtocol_SUMD(frontend);
+    case AP_RCProtocol::ST24:
+        return new AP_RCProtocol_ST24(frontend);
+    case AP_RCProtocol::FPORT:
+        return new AP_RCProtocol_FPort(frontend, true);
+    default:
+        return nullptr;
+    }
+}
+
+// channel values after each frame a backend decoded
+struct Decoded {
+    uint8_t num_frames;
+    uint8_t num_channels[MAX_STREAM_LEN];
+    uint16_t values[MAX_STREAM_LEN][MAX_RCIN_CHANNELS];
+};
+
+/*
+  feed a stream to a single backend, either passing it every byte as
+  the search used to, or skipping the bytes it says it can skip
+ */
+static void decode_stream(const StreamTest &t, const Stream &s, bool skip, Decoded &d)
+{
+    // allocate with new, which zeroes memory, as the classes rely on
+    AP_RCProtocol *frontend = new AP_RCProtocol();
+    AP_RCProtocol_Backend *backend = new_backend(*frontend, t.protocol);
+    ASSERT_NE(backend, nullptr);
+    ASSERT_TRUE(backend->accepts_baudrate(t.baudrate));
+
+    memset(&d, 0, sizeof(d));
+    for (uint16_t i=0; i<s.len; i++) {
+        frame_gap(t, s, i);
+        if (skip && backend->can_skip_byte(s.bytes[i])) {
+            continue;
+        }
+        const uint32_t frame_count = backend->get_rc_frame_count();
+        backend->process_byte(s.bytes[i], t.baudrate);
+        if (backend->get_rc_frame_count() != frame_count) {
+            d.num_channels[d.num_frames] = backend->num_channels();
+            backend->read(d.values[d.num_frames], MAX_RCIN_CHANNELS);
+            d.num_frames++;
+        }
+    }
+    delete backend;
+    delete frontend;
+}
+
+/*
+  feed a stream to the frontend a byte at a time, or in chunks of up
+  to chunk_len bytes as a uart DMA buffer would give us
+ */
+static void detect_stream(const StreamTest &t, const Stream &s, uint16_t chunk_len,
+                          AP_RCProtocol::rcprotocol_t &protocol, uint8_t &num_channels, uint16_t *values)
+{
+    AP_RCProtocol *rcprot = new AP_RCProtocol();
+    rcprot->init();
+    uint16_t ofs = 0;
+    while (ofs < s.len) {
+        frame_gap(t, s, ofs);
+        const uint16_t n = MIN(chunk_len, piece_len(s, ofs));
+        if (chunk_len == 1) {
+            rcprot->process_byte(s.bytes[ofs], t.baudrate);
+        } else {
+            rcprot->process_bytes(&s.bytes[ofs], n, t.baudrate);
+        }
+        ofs += n;
+    }
+    protocol = rcprot->protocol_detected();
+    num_channels = 0;
+    if (protocol != AP_RCProtocol::NONE && rcprot->new_input()) {
+        num_channels = rcprot->num_channels();
+        for (uint8_t i=0; i<num_channels; i++) {
+            values[i] = rcprot->read(i);
+        }
+    }
+    delete rcprot;
+}
+
+TEST(RCProtocolBytes, skip_byte_decodes_same_frames)
+{
+    static Stream s;
+    static Decoded all, skipped;
+    for (const auto &t : stream_tests) {
+        for (uint8_t noise_len=0; noise_len<=sizeof(noise); noise_len += 5) {
+            for (uint8_t start_ofs=0; start_ofs<t.frame_len; start_ofs++) {
+                SCOPED_TRACE(::testing::Message() << t.name << " noise " << unsigned(noise_len) << " start " << unsigned(start_ofs));
+                build_stream(t, noise_len, start_ofs, s);
+                decode_stream(t, s, false, all);
+                decode_stream(t, s, true, skipped);
+
+                // noise which looks like a header can swallow the
+                // next frames, but decoding must recover
+                EXPECT_GE(all.num_frames, NUM_FRAMES-2);
+                ASSERT_EQ(all.num_frames, skipped.num_frames);
+                for (uint8_t f=0; f<all.num_frames; f++) {
+                    ASSERT_EQ(all.num_channels[f], skipped.num_channels[f]);
+                    for (uint8_t c=0; c<all.num_channels[f]; c++) {
+                        EXPECT_EQ(all.values[f][c], skipped.values[f][c]);
+                    }
+                }
+                ASSERT_GT(all.num_frames, 0);
+                const uint8_t last = all.num_frames-1;
+                ASSERT_EQ(all.num_channels[last], t.num_output);
+                for (uint8_t c=0; c<t.num_output; c++) {
+                    EXPECT_EQ(all.values[last][c], t.output[c]);
+                }
+            }
+        }
+    }
+}
+
+TEST(RCProtocolBytes, batch_detects_same_protocol)
+{
+    static Stream s;
+    const uint16_t chunk_lens[] = { 7, 64, MAX_STREAM_LEN };
+    for (const auto &t : stream_tests) {
+        for (uint8_t start_ofs=0; start_ofs<t.frame_len; start_ofs += 5) {
+            SCOPED_TRACE(::testing::Message() << t.name << " start " << unsigned(start_ofs));
+            build_stream(t, sizeof(noise), start_ofs, s);
+
+            AP_RCProtocol::rcprotocol_t protocol1;
+            uint8_t num_channels1;
+            uint16_t values1[MAX_RCIN_CHANNELS];
+            detect_stream(t, s, 1, protocol1, num_channels1, values1);
+            EXPECT_EQ(protocol1, t.protocol);
+            ASSERT_EQ(num_channels1, t.num_output);
+            for (uint8_t c=0; c<t.num_output; c++) {
+                EXPECT_EQ(values1[c], t.output[c]);
+            }
+
+            for (const auto chunk_len : chunk_lens) {
+                SCOPED_TRACE(::testing::Message() << "chunk " << chunk_len);
+                AP_RCProtocol::rcprotocol_t protocol2;
+                uint8_t num_channels2;
+                uint16_t values2[MAX_RCIN_CHANNELS];
+                detect_stream(t, s, chunk_len, protocol2, num_channels2, values2);
+                EXPECT_EQ(protocol1, protocol2);
+                ASSERT_EQ(num_channels1, num_channels2);
+                for (uint8_t c=0; c<num_channels1; c++) {
+                    EXPECT_EQ(values1[c], values2[c]);
+                }
+            }
+        }
+    }
+}
+
+AP_GTEST_MAIN()
@@ -49,7 +49,7 @@ const AP_Param::GroupInfo AP_Terrain::var_info[] = {
 
     // @Param: SPACING
     // @DisplayName: Terrain grid spacing
-    // @Description: Distance between terrain grid points in meters. This controls the horizontal resolution of the terrain data that is stored on te SD card and requested from the ground station. If your GCS is using the ArduPilot SRTM database like Mission Planner or MAVProxy, then a resolution of 100 meters is appropriate. Grid spacings lower than 100 meters waste SD card space if the GCS cannot provide that resolution. The grid spacing also controls how much data is kept in memory during flight. A larger grid spacing will allow for a larger amount of data in memory. A grid spacing of 100 meters results in the vehicle keeping 12 grid squares in memory with each grid square having a size of 2.7 kilometers by 3.2 kilometers. Any additional grid squares are stored on the SD once they are fetched from the GCS and will be loaded as needed.
+    // @Description: Distance between terrain grid points in meters. This controls the horizontal resolution of the terrain data that is stored on te SD card and requested from the ground station. If your GCS is using the ArduPilot SRTM database like Mission Planner or MAVProxy, then a resolution of 100 meters is appropriate. Grid spacings lower than 100 meters waste SD card space if the GCS cannot provide that resolution. The grid spacing also controls how much data is kept in memory during flight. A larger grid spacing will allow for a larger amount of data in memory. A grid spacing of 100 meters results in each grid square kept in memory having a size of 2.7 kilometers by 3.2 kilometers, with the number of grid squares set by TERRAIN_CACHE_SZ. Any additional grid squares are stored on the SD once they are fetched from the GCS and will be loaded as needed.
     // @Units: m
     // @Increment: 1
     // @User: Advanced
@@ -77,13 +77,20 @@ const AP_Param::GroupInfo AP_Terrain::var_info[] = {
     // @Range: 0 50
     // @User: Advanced
     AP_GROUPINFO("OFS_MAX",  4, AP_Terrain, offset_max, 30),
+
+    // @Param: CACHE_SZ
+    // @DisplayName: Terrain cache size
+    // @Description: The number of terrain grid blocks kept in memory. Each grid block uses about 2 kilobytes of memory and covers 28x32 grid points. The first 12 blocks hold the data around the vehicle and home. Any additional blocks are used to load terrain data along the mission, and along the path to the best rally point or home, before the vehicle gets there.
+    // @Range: 12 128
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("CACHE_SZ", 5, AP_Terrain, config_cache_size, TERRAIN_GRID_BLOCK_CACHE_SIZE),
     
     AP_GROUPEND
 };
 
 // constructor
 AP_Terrain::AP_Terrain() :
-    disk_io_state(DiskIoIdle),
     fd(-1)
 {
     AP_Param::setup_object_defaults(this, var_info);
@@ -385,6 +392,8 @@ void AP_Terrain::update(void)
     // update tiles surrounding our current location:
     if (pos_valid) {
         have_surrounding_tiles = update_surrounding_tiles(loc);
+        // and load blocks along the path ahead of us
+        update_prefetch(loc);
     } else {
         have_surrounding_tiles = false;
     }
@@ -425,9 +434,10 @@ bool AP_Terrain::update_surrounding_tiles(const Location &loc)
 
 bool AP_Terrain::pre_arm_checks(char *failure_msg, uint8_t failure_msg_len) const
 {
-    // check no outstanding requests for data:
+    // check no outstanding requests for data. Blocks only wanted by
+    // prefetch along the flight path don't hold up arming
     uint16_t terr_pending, terr_loaded;
-    get_statistics(terr_pending, terr_loaded);
+    get_statistics(terr_pending, terr_loaded, false);
     if (terr_pending != 0 ||
         !have_current_loc_height ||
         !have_home_height ||
@@ -488,13 +498,19 @@ bool AP_Terrain::allocate(void)
     if (cache != nullptr) {
         return true;
     }
-    cache = (struct grid_cache *)calloc(TERRAIN_GRID_BLOCK_CACHE_SIZE, sizeof(cache[0]));
-    if (cache == nullptr) {
+    const uint16_t size = constrain_int16(config_cache_size, TERRAIN_PREFETCH_RESERVE, TERRAIN_GRID_BLOCK_CACHE_SIZE_MAX);
+    cache = (struct grid_cache *)calloc(size, sizeof(cache[0]));
+    disk_io = (struct disk_io_slot *)calloc(TERRAIN_IO_QUEUE_SIZE, sizeof(disk_io[0]));
+    if (cache == nullptr || disk_io == nullptr) {
+        free(cache);
+        free(disk_io);
+        cache = nullptr;
+        disk_io = nullptr;
         GCS_SEND_TEXT(MAV_SEVERITY_CRITICAL, "Terrain: Allocation failed");
         memory_alloc_failed = true;
         return false;
     }
-    cache_size = TERRAIN_GRID_BLOCK_CACHE_SIZE;
+    cache_size = size;
     return true;
 }
 
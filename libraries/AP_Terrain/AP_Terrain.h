@@ -50,8 +50,44 @@
 #define TERRAIN_GRID_BLOCK_SIZE_X (TERRAIN_GRID_MAVLINK_SIZE*TERRAIN_GRID_BLOCK_MUL_X)
 #define TERRAIN_GRID_BLOCK_SIZE_Y (TERRAIN_GRID_MAVLINK_SIZE*TERRAIN_GRID_BLOCK_MUL_Y)
 
-// number of grid_blocks in the LRU memory cache
+// default number of grid_blocks in the LRU memory cache
+#ifndef TERRAIN_GRID_BLOCK_CACHE_SIZE
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_1000
+#define TERRAIN_GRID_BLOCK_CACHE_SIZE 32
+#elif HAL_MEM_CLASS >= HAL_MEM_CLASS_500
+#define TERRAIN_GRID_BLOCK_CACHE_SIZE 16
+#else
 #define TERRAIN_GRID_BLOCK_CACHE_SIZE 12
+#endif
+#endif
+
+// maximum number of grid_blocks in the memory cache
+#define TERRAIN_GRID_BLOCK_CACHE_SIZE_MAX 128
+
+// number of grid_blocks kept for the 9 blocks surrounding the
+// vehicle and for home. Any blocks beyond this are used to prefetch
+// blocks along the path ahead of the vehicle
+#define TERRAIN_PREFETCH_RESERVE 12
+
+// interval between prefetch passes
+#define TERRAIN_PREFETCH_INTERVAL_MS 1000
+
+// maximum number of path samples checked in each prefetch pass
+#define TERRAIN_PREFETCH_MAX_SAMPLES 200
+
+// maximum number of mission legs looked ahead by prefetch
+#define TERRAIN_PREFETCH_MAX_LEGS 8
+
+// number of grid_blocks that can be queued for disk IO at once
+#ifndef TERRAIN_IO_QUEUE_SIZE
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_1000
+#define TERRAIN_IO_QUEUE_SIZE 8
+#elif HAL_MEM_CLASS >= HAL_MEM_CLASS_500
+#define TERRAIN_IO_QUEUE_SIZE 4
+#else
+#define TERRAIN_IO_QUEUE_SIZE 1
+#endif
+#endif
 
 // format of grid on disk
 #define TERRAIN_GRID_FORMAT_VERSION 1
@@ -181,9 +217,10 @@ public:
 #endif
 
     /*
-      get some statistics for TERRAIN_REPORT
+      get some statistics for TERRAIN_REPORT. If include_prefetch is
+      false then blocks only requested by prefetch are not counted
      */
-    void get_statistics(uint16_t &pending, uint16_t &loaded) const;
+    void get_statistics(uint16_t &pending, uint16_t &loaded, bool include_prefetch=true) const;
 
     /*
       get grid spacing in meters
@@ -265,6 +302,13 @@ private:
 
         // the last time access was requested to this block, used for LRU
         uint32_t last_access_ms;
+
+        // true if loaded by prefetch and not yet used. Disk reads of
+        // these blocks are done after blocks that are in use
+        bool prefetch;
+
+        // prefetch pass that last requested this block
+        uint8_t prefetch_pass;
     };
 
     /*
@@ -300,9 +344,10 @@ private:
     void calculate_grid_info(const Location &loc, struct grid_info &info) const;
 
     /*
-      find a grid structure given a grid_info
+      find a grid structure given a grid_info. If prefetch is true
+      then the block is being loaded ahead of use
     */
-    struct grid_cache &find_grid_cache(const struct grid_info &info);
+    struct grid_cache &find_grid_cache(const struct grid_info &info, bool prefetch=false);
 
     /*
       calculate bit number in grid_block bitmap. This corresponds to a
@@ -335,16 +380,19 @@ private:
     /*
       disk IO functions
      */
-    int16_t find_io_idx(enum GridCacheState state);
+    struct disk_io_slot;
+    int16_t find_io_idx(const struct disk_io_slot &io, enum GridCacheState state);
     uint16_t get_block_crc(struct grid_block &block);
     void check_disk_read(void);
     void check_disk_write(void);
+    bool queue_disk_io(const struct grid_block &block, enum GridCacheState cache_state);
     void io_timer(void);
-    void open_file(void);
-    void seek_offset(void);
-    uint32_t east_blocks(struct grid_block &block) const;
-    void write_block(void);
-    void read_block(void);
+    void open_file(const struct grid_block &block);
+    bool seek_offset(const struct disk_io_slot &io);
+    uint32_t east_blocks(const struct grid_block &block) const;
+    uint32_t block_file_offset(const struct grid_block &block) const;
+    bool write_block(struct disk_io_slot &io);
+    void read_block(struct disk_io_slot &io);
 
     // check for missing data in squares surrounding loc:
     bool update_surrounding_tiles(const Location &loc);
@@ -359,6 +407,13 @@ private:
      */
     void update_rally_data(void);
 
+    /*
+      prefetch grid blocks along the expected flight path
+     */
+    void update_prefetch(const Location &loc);
+    bool prefetch_path(const Location &from, const Location &to, uint16_t budget);
+    bool prefetch_block(const Location &loc, uint16_t budget);
+
     /*
       calculate reference offset if needed
      */
@@ -371,16 +426,23 @@ private:
     AP_Int16 grid_spacing; // meters between grid points
     AP_Int16 options; // option bits
     AP_Float offset_max;
+    AP_Int16 config_cache_size;
 
     enum class Options {
         DisableDownload = (1U<<0),
     };
 
     // cache of grids in memory, LRU
-    uint8_t cache_size = 0;
+    uint16_t cache_size = 0;
     struct grid_cache *cache = nullptr;
 
-    // a grid_cache block waiting for disk IO
+    // state of the current prefetch pass
+    uint32_t last_prefetch_ms;
+    uint8_t prefetch_pass;
+    uint16_t prefetch_count;
+    uint16_t prefetch_samples;
+
+    // state of a disk IO queue slot
     enum DiskIoState {
         DiskIoIdle      = 0,
         DiskIoWaitWrite = 1,
@@ -388,8 +450,25 @@ private:
         DiskIoDoneRead  = 3,
         DiskIoDoneWrite = 4
     };
-    volatile enum DiskIoState disk_io_state;
-    union grid_io_block disk_block;
+
+    /*
+      a grid_cache block queued for disk IO. The lat/lon of the block
+      is kept separately as the IO thread owns the block data while
+      the IO is in progress
+     */
+    struct disk_io_slot {
+        volatile enum DiskIoState state;
+        int32_t lat;
+        int32_t lon;
+        // offset in the degree file, set by the IO thread
+        uint32_t file_offset;
+        union grid_io_block disk_block;
+    };
+    struct disk_io_slot *disk_io = nullptr;
+
+    // file position after the last disk IO, or -1 if unknown. Used
+    // to avoid seeks between neighbouring blocks
+    int32_t file_pos = -1;
 
     // last time we asked for more grids
     uint32_t last_request_time_ms[MAVLINK_COMM_NUM_BUFFERS];
@@ -169,7 +169,7 @@ uint8_t AP_Terrain::bitcount64(uint64_t b) const
 /*
   get some statistics for TERRAIN_REPORT
 */
-void AP_Terrain::get_statistics(uint16_t &pending, uint16_t &loaded) const
+void AP_Terrain::get_statistics(uint16_t &pending, uint16_t &loaded, bool include_prefetch) const
 {
     pending = 0;
     loaded = 0;
@@ -180,6 +180,9 @@ void AP_Terrain::get_statistics(uint16_t &pending, uint16_t &loaded) const
         if (cache[i].state == GRID_CACHE_INVALID) {
             continue;
         }
+        if (cache[i].prefetch && !include_prefetch) {
+            continue;
+        }
         uint8_t maskbits = TERRAIN_GRID_BLOCK_MUL_X*TERRAIN_GRID_BLOCK_MUL_Y;
         if (cache[i].state == GRID_CACHE_DISKWAIT) {
             pending += maskbits;
@@ -29,17 +29,52 @@
 extern const AP_HAL::HAL& hal;
 
 /*
-  check for blocks that need to be read from disk
+  queue a block for disk IO. Returns false if the queue is full
+ */
+bool AP_Terrain::queue_disk_io(const struct grid_block &block, enum GridCacheState cache_state)
+{
+    int16_t idle_idx = -1;
+    for (uint8_t i=0; i<TERRAIN_IO_QUEUE_SIZE; i++) {
+        const struct disk_io_slot &io = disk_io[i];
+        if (io.state == DiskIoIdle) {
+            if (idle_idx == -1) {
+                idle_idx = i;
+            }
+            continue;
+        }
+        if (TERRAIN_LATLON_EQUAL(io.lat,block.lat) &&
+            TERRAIN_LATLON_EQUAL(io.lon,block.lon)) {
+            // already queued or in progress
+            return true;
+        }
+    }
+    if (idle_idx == -1) {
+        return false;
+    }
+    struct disk_io_slot &io = disk_io[idle_idx];
+    io.lat = block.lat;
+    io.lon = block.lon;
+    io.disk_block.block = block;
+    io.state = cache_state == GRID_CACHE_DISKWAIT ? DiskIoWaitRead : DiskIoWaitWrite;
+    return true;
+}
+
+/*
+  check for blocks that need to be read from disk. Blocks that are in
+  use are queued before prefetched blocks
  */
 void AP_Terrain::check_disk_read(void)
 {
-    for (uint16_t i=0; i<cache_size; i++) {
-        if (cache[i].state == GRID_CACHE_DISKWAIT) {
-            disk_block.block = cache[i].grid;
-            disk_io_state = DiskIoWaitRead;
-            return;
+    for (uint8_t pass=0; pass<2; pass++) {
+        for (uint16_t i=0; i<cache_size; i++) {
+            if (cache[i].state == GRID_CACHE_DISKWAIT &&
+                cache[i].prefetch == (pass == 1)) {
+                if (!queue_disk_io(cache[i].grid, GRID_CACHE_DISKWAIT)) {
+                    return;
+                }
+            }
         }
-    }    
+    }
 }
 
 /*
@@ -49,15 +84,17 @@ void AP_Terrain::check_disk_write(void)
 {
     for (uint16_t i=0; i<cache_size; i++) {
         if (cache[i].state == GRID_CACHE_DIRTY) {
-            disk_block.block = cache[i].grid;
-            disk_io_state = DiskIoWaitWrite;
-            return;
+            if (!queue_disk_io(cache[i].grid, GRID_CACHE_DIRTY)) {
+                return;
+            }
         }
     }    
 }
 
 /*
-  Check if we need to do disk IO for grids. 
+  Check if we need to do disk IO for grids. Completed IO is handed
+  back to the cache, then any idle queue slots are filled with blocks
+  needing reads and then writes
  */
 void AP_Terrain::schedule_disk_io(void)
 {
@@ -70,72 +107,73 @@ void AP_Terrain::schedule_disk_io(void)
         hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&AP_Terrain::io_timer, void));
     }
 
-    switch (disk_io_state) {
-    case DiskIoIdle:
-        // look for a block that needs reading or writing
-        check_disk_read();
-        if (disk_io_state == DiskIoIdle) {
-            // still idle, check for writes
-            check_disk_write();            
-        }
-        break;
-        
-    case DiskIoDoneRead: {
-        // a read has completed
-        int16_t cache_idx = find_io_idx(GRID_CACHE_DISKWAIT);
-        if (cache_idx != -1) {
-            if (disk_block.block.bitmap != 0) {
-                // when bitmap is zero we read an empty block
-                cache[cache_idx].grid = disk_block.block;
+    for (uint8_t i=0; i<TERRAIN_IO_QUEUE_SIZE; i++) {
+        struct disk_io_slot &io = disk_io[i];
+        switch (io.state) {
+        case DiskIoDoneRead: {
+            // a read has completed
+            int16_t cache_idx = find_io_idx(io, GRID_CACHE_DISKWAIT);
+            if (cache_idx != -1) {
+                if (io.disk_block.block.bitmap != 0) {
+                    // when bitmap is zero we read an empty block
+                    cache[cache_idx].grid = io.disk_block.block;
+                }
+                cache[cache_idx].state = GRID_CACHE_VALID;
+                cache[cache_idx].last_access_ms = AP_HAL::millis();
             }
-            cache[cache_idx].state = GRID_CACHE_VALID;
-            cache[cache_idx].last_access_ms = AP_HAL::millis();
+            io.state = DiskIoIdle;
+            break;
         }
-        disk_io_state = DiskIoIdle;
-        break;
-    }
 
-    case DiskIoDoneWrite: {
-        // a write has completed
-        int16_t cache_idx = find_io_idx(GRID_CACHE_DIRTY);
-        if (cache_idx != -1) {
-            if (cache[cache_idx].grid.bitmap == disk_block.block.bitmap) {
-                // only mark valid if more grids haven't been added
-                cache[cache_idx].state = GRID_CACHE_VALID;
+        case DiskIoDoneWrite: {
+            // a write has completed
+            int16_t cache_idx = find_io_idx(io, GRID_CACHE_DIRTY);
+            if (cache_idx != -1) {
+                if (cache[cache_idx].grid.bitmap == io.disk_block.block.bitmap) {
+                    // only mark valid if more grids haven't been added
+                    cache[cache_idx].state = GRID_CACHE_VALID;
+                }
             }
+            io.state = DiskIoIdle;
+            break;
+        }
+
+        case DiskIoIdle:
+        case DiskIoWaitWrite:
+        case DiskIoWaitRead:
+            break;
         }
-        disk_io_state = DiskIoIdle;
-        break;
-    }
-        
-    case DiskIoWaitWrite:
-    case DiskIoWaitRead:
-        // waiting for io_timer()
-        break;
     }
+
+    // look for blocks that need reading or writing
+    check_disk_read();
+    check_disk_write();
 }
 
 
 /********************************************************
 All the functions below this point run in the IO timer context, which
-is a separate thread. The code uses the state machine controlled by
-disk_io_state to manage who has access to the structures and to
-prevent race conditions.
-
-The IO timer context owns the data when disk_io_state is
-DiskIoWaitWrite or DiskIoWaitRead. The main thread owns the data when
-disk_io_state is DiskIoIdle, DiskIoDoneWrite or DiskIoDoneRead
-
-All file operations are done by the IO thread.
+is a separate thread. The code uses the state of each disk_io_slot to
+manage who has access to the structures and to prevent race
+conditions.
+
+The IO timer context owns the data of a slot when its state is
+DiskIoWaitWrite or DiskIoWaitRead.
+The main thread owns the data when the state is DiskIoIdle,
+DiskIoDoneWrite or DiskIoDoneRead
+
+All file operations are done by the IO thread. All queued slots are
+handled in one pass in file order, so neighbouring blocks are read or
+written without a seek between them, and writes are synced to the
+card once per pass.
 *********************************************************/
 
 
 /*
-  open the current degree file
+  open the degree file for a block
  */
-void AP_Terrain::open_file(void)
+void AP_Terrain::open_file(const struct grid_block &block)
 {
-    struct grid_block &block = disk_block.block;
     if (fd != -1 && 
         block.lat_degrees == file_lat_degrees &&
         block.lon_degrees == file_lon_degrees) {
@@ -200,6 +238,7 @@ void AP_Terrain::open_file(void)
     if (fd != -1) {
         AP::FS().close(fd);
     }
+    file_pos = -1;
     fd = AP::FS().open(file_path, O_RDWR|O_CREAT);
     if (fd == -1) {
 #if TERRAIN_DEBUG
@@ -217,7 +256,7 @@ void AP_Terrain::open_file(void)
 /*
   work out how many blocks needed in a stride for a given location
  */
-uint32_t AP_Terrain::east_blocks(struct grid_block &block) const
+uint32_t AP_Terrain::east_blocks(const struct grid_block &block) const
 {
     Location loc1, loc2;
     loc1.lat = block.lat_degrees*10*1000*1000L;
@@ -232,110 +271,129 @@ uint32_t AP_Terrain::east_blocks(struct grid_block &block) const
 }
 
 /*
-  seek to the right offset for disk_block
+  get the offset of a block in its degree file
  */
-void AP_Terrain::seek_offset(void)
+uint32_t AP_Terrain::block_file_offset(const struct grid_block &block) const
 {
-    struct grid_block &block = disk_block.block;
     // work out how many longitude blocks there are at this latitude
     uint32_t blocknum = east_blocks(block) * block.grid_idx_x + block.grid_idx_y;
-    uint32_t file_offset = blocknum * sizeof(union grid_io_block);
-    if (AP::FS().lseek(fd, file_offset, SEEK_SET) != (off_t)file_offset) {
+    return blocknum * sizeof(union grid_io_block);
+}
+
+/*
+  seek to the right offset for a disk IO slot, unless the file is
+  already there from the previous IO
+ */
+bool AP_Terrain::seek_offset(const struct disk_io_slot &io)
+{
+    if (file_pos == int32_t(io.file_offset)) {
+        return true;
+    }
+    if (AP::FS().lseek(fd, io.file_offset, SEEK_SET) != (off_t)io.file_offset) {
 #if TERRAIN_DEBUG
         hal.console->printf("Seek %lu failed - %s\n",
-                            (unsigned long)file_offset, strerror(errno));
+                            (unsigned long)io.file_offset, strerror(errno));
 #endif
         AP::FS().close(fd);
         fd = -1;
+        file_pos = -1;
         io_failure = true;
+        return false;
     }
+    file_pos = io.file_offset;
+    return true;
 }
 
 /*
-  write out disk_block
+  write out the block of a disk IO slot. The caller syncs the file
  */
-void AP_Terrain::write_block(void)
+bool AP_Terrain::write_block(struct disk_io_slot &io)
 {
-    seek_offset();
-    if (io_failure) {
-        return;
+    if (!seek_offset(io)) {
+        return false;
     }
 
-    disk_block.block.crc = get_block_crc(disk_block.block);
+    io.disk_block.block.crc = get_block_crc(io.disk_block.block);
 
-    ssize_t ret = AP::FS().write(fd, &disk_block, sizeof(disk_block));
-    if (ret  != sizeof(disk_block)) {
+    ssize_t ret = AP::FS().write(fd, &io.disk_block, sizeof(io.disk_block));
+    if (ret  != sizeof(io.disk_block)) {
 #if TERRAIN_DEBUG
         hal.console->printf("write failed - %s\n", strerror(errno));
 #endif
         AP::FS().close(fd);
         fd = -1;
+        file_pos = -1;
         io_failure = true;
-    } else {
-        AP::FS().fsync(fd);
+        return false;
+    }
+    file_pos += sizeof(io.disk_block);
 #if TERRAIN_DEBUG
-        printf("wrote block at %ld %ld ret=%d mask=%07llx\n",
-               (long)disk_block.block.lat,
-               (long)disk_block.block.lon,
-               (int)ret,
-               (unsigned long long)disk_block.block.bitmap);
+    printf("wrote block at %ld %ld ret=%d mask=%07llx\n",
+           (long)io.disk_block.block.lat,
+           (long)io.disk_block.block.lon,
+           (int)ret,
+           (unsigned long long)io.disk_block.block.bitmap);
 #endif
-    }
-    disk_io_state = DiskIoDoneWrite;
+    return true;
 }
 
 /*
-  read in disk_block
+  read in the block of a disk IO slot
  */
-void AP_Terrain::read_block(void)
+void AP_Terrain::read_block(struct disk_io_slot &io)
 {
-    seek_offset();
-    if (io_failure) {
+    if (!seek_offset(io)) {
         return;
     }
-    int32_t lat = disk_block.block.lat;
-    int32_t lon = disk_block.block.lon;
-
-    ssize_t ret = AP::FS().read(fd, &disk_block, sizeof(disk_block));
-    if (ret != sizeof(disk_block) || 
-        !TERRAIN_LATLON_EQUAL(disk_block.block.lat,lat) ||
-        !TERRAIN_LATLON_EQUAL(disk_block.block.lon,lon) ||
-        disk_block.block.bitmap == 0 ||
-        disk_block.block.spacing != grid_spacing ||
-        disk_block.block.version != TERRAIN_GRID_FORMAT_VERSION ||
-        disk_block.block.crc != get_block_crc(disk_block.block)) {
+    struct grid_block &block = io.disk_block.block;
+    int32_t lat = block.lat;
+    int32_t lon = block.lon;
+
+    ssize_t ret = AP::FS().read(fd, &io.disk_block, sizeof(io.disk_block));
+    if (ret == sizeof(io.disk_block)) {
+        file_pos += sizeof(io.disk_block);
+    } else {
+        file_pos = -1;
+    }
+    if (ret != sizeof(io.disk_block) || 
+        !TERRAIN_LATLON_EQUAL(block.lat,lat) ||
+        !TERRAIN_LATLON_EQUAL(block.lon,lon) ||
+        block.bitmap == 0 ||
+        block.spacing != grid_spacing ||
+        block.version != TERRAIN_GRID_FORMAT_VERSION ||
+        block.crc != get_block_crc(block)) {
 #if TERRAIN_DEBUG
         printf("read empty block at %ld %ld ret=%d (%ld %ld %u 0x%08lx) 0x%04x:0x%04x\n",
                (long)lat,
                (long)lon,
                (int)ret,
-               (long)disk_block.block.lat,
-               (long)disk_block.block.lon,
-               (unsigned)disk_block.block.spacing,
-               (unsigned long)disk_block.block.bitmap,
-               (unsigned)disk_block.block.crc,
-               (unsigned)get_block_crc(disk_block.block));
+               (long)block.lat,
+               (long)block.lon,
+               (unsigned)block.spacing,
+               (unsigned long)block.bitmap,
+               (unsigned)block.crc,
+               (unsigned)get_block_crc(block));
 #endif
         // a short read or bad data is not an IO failure, just a
         // missing block on disk
-        memset(&disk_block, 0, sizeof(disk_block));
-        disk_block.block.lat = lat;
-        disk_block.block.lon = lon;
-        disk_block.block.bitmap = 0;
+        memset(&io.disk_block, 0, sizeof(io.disk_block));
+        block.lat = lat;
+        block.lon = lon;
+        block.bitmap = 0;
     } else {
 #if TERRAIN_DEBUG
         printf("read block at %ld %ld ret=%d mask=%07llx\n",
                (long)lat,
                (long)lon,
                (int)ret,
-               (unsigned long long)disk_block.block.bitmap);
+               (unsigned long long)block.bitmap);
 #endif
     }
-    disk_io_state = DiskIoDoneRead;
+    io.state = DiskIoDoneRead;
 }
 
 /*
-  timer called to do disk IO
+  timer called to do disk IO. All queued IO is done in file order
  */
 void AP_Terrain::io_timer(void)
 {
@@ -351,30 +409,72 @@ void AP_Terrain::io_timer(void)
 
     update_reference_offset();
 
-    switch (disk_io_state) {
-    case DiskIoIdle:
-    case DiskIoDoneRead:
-    case DiskIoDoneWrite:
-        // nothing to do
-        break;
-        
-    case DiskIoWaitWrite:
-        // need to write out the block
-        open_file();
-        if (fd == -1) {
-            return;
+    // sort the queued slots by degree file and offset
+    uint8_t order[TERRAIN_IO_QUEUE_SIZE];
+    uint8_t count = 0;
+    for (uint8_t i=0; i<TERRAIN_IO_QUEUE_SIZE; i++) {
+        struct disk_io_slot &io = disk_io[i];
+        if (io.state != DiskIoWaitRead && io.state != DiskIoWaitWrite) {
+            continue;
+        }
+        const struct grid_block &block = io.disk_block.block;
+        io.file_offset = block_file_offset(block);
+        uint8_t j = count++;
+        while (j > 0) {
+            const struct disk_io_slot &prev = disk_io[order[j-1]];
+            const struct grid_block &pblock = prev.disk_block.block;
+            if (pblock.lat_degrees < block.lat_degrees ||
+                (pblock.lat_degrees == block.lat_degrees &&
+                 (pblock.lon_degrees < block.lon_degrees ||
+                  (pblock.lon_degrees == block.lon_degrees && prev.file_offset <= io.file_offset)))) {
+                break;
+            }
+            order[j] = order[j-1];
+            j--;
         }
-        write_block();
-        break;
+        order[j] = i;
+    }
 
-    case DiskIoWaitRead:
-        // need to read in the block
-        open_file();
+    // slots written in this pass, completed once the file is synced
+    uint8_t written[TERRAIN_IO_QUEUE_SIZE];
+    uint8_t num_written = 0;
+
+    for (uint8_t i=0; i<count; i++) {
+        struct disk_io_slot &io = disk_io[order[i]];
+        const struct grid_block &block = io.disk_block.block;
+        if (num_written > 0 &&
+            (block.lat_degrees != file_lat_degrees ||
+             block.lon_degrees != file_lon_degrees)) {
+            // moving to another file, sync the writes to this one
+            AP::FS().fsync(fd);
+            while (num_written > 0) {
+                disk_io[written[--num_written]].state = DiskIoDoneWrite;
+            }
+        }
+        open_file(block);
         if (fd == -1) {
-            return;
+            break;
+        }
+        if (io.state == DiskIoWaitWrite) {
+            if (!write_block(io)) {
+                break;
+            }
+            written[num_written++] = order[i];
+        } else {
+            read_block(io);
+        }
+        if (io_failure) {
+            break;
+        }
+    }
+
+    if (num_written > 0) {
+        if (fd != -1) {
+            AP::FS().fsync(fd);
+        }
+        while (num_written > 0) {
+            disk_io[written[--num_written]].state = DiskIoDoneWrite;
         }
-        read_block();
-        break;
     }
 }
 
@@ -26,6 +26,7 @@
 #include <AP_Mission/AP_Mission.h>
 #include <AP_Rally/AP_Rally.h>
 #include <AP_GPS/AP_GPS.h>
+#include <AP_AHRS/AP_AHRS.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -173,4 +174,118 @@ void AP_Terrain::update_rally_data(void)
 }
 #endif
 
+/*
+  prefetch grid blocks along the path the vehicle is expected to
+  fly. When a mission is running this is the path along the next
+  mission legs. The path to the RTL destination (the best rally point
+  or home) is also loaded, so that terrain data is available if we
+  need to return.
+
+  Blocks are loaded into the cache, and requested from the GCS if
+  missing, before the vehicle reaches them. Only cache blocks beyond
+  TERRAIN_PREFETCH_RESERVE are used, so prefetch does not evict the
+  blocks around the vehicle. This is called from update() at 10Hz,
+  but a pass is only made every TERRAIN_PREFETCH_INTERVAL_MS
+ */
+void AP_Terrain::update_prefetch(const Location &loc)
+{
+    if (cache_size <= TERRAIN_PREFETCH_RESERVE || grid_spacing <= 0) {
+        return;
+    }
+    const uint32_t now = AP_HAL::millis();
+    if (now - last_prefetch_ms < TERRAIN_PREFETCH_INTERVAL_MS) {
+        return;
+    }
+    last_prefetch_ms = now;
+    const uint16_t budget = cache_size - TERRAIN_PREFETCH_RESERVE;
+
+    // start a new pass. Each block is counted once per pass against
+    // the budget
+    prefetch_pass++;
+    prefetch_count = 0;
+    prefetch_samples = 0;
+
+    // leave a third of the budget for the return path
+    const uint16_t mission_budget = budget - budget/3;
+
+#if AP_MISSION_ENABLED
+    AP_Mission *mission = AP::mission();
+    if (mission != nullptr && mission->state() == AP_Mission::MISSION_RUNNING) {
+        Location from = loc;
+        AP_Mission::Mission_Command cmd = mission->get_current_nav_cmd();
+        for (uint8_t leg=0; leg<TERRAIN_PREFETCH_MAX_LEGS; leg++) {
+            if (AP_Mission::cmd_has_location(cmd.id) &&
+                (cmd.content.location.lat != 0 || cmd.content.location.lng != 0)) {
+                if (!prefetch_path(from, cmd.content.location, mission_budget)) {
+                    break;
+                }
+                from = cmd.content.location;
+            }
+            if (!mission->get_next_nav_cmd(cmd.index+1, cmd)) {
+                break;
+            }
+        }
+    }
+#endif
+
+    // path to the RTL destination
+    const AP_AHRS &ahrs = AP::ahrs();
+    if (!ahrs.home_is_set()) {
+        return;
+    }
+#if HAL_RALLY_ENABLED
+    const AP_Rally *rally = AP::rally();
+    const Location dest = rally != nullptr ? rally->calc_best_rally_or_home_location(loc, 0) : ahrs.get_home();
+#else
+    const Location dest = ahrs.get_home();
+#endif
+    prefetch_path(loc, dest, budget);
+}
+
+/*
+  prefetch the grid blocks along a straight path. Returns false once
+  the block budget or the sample limit for this pass is used up
+ */
+bool AP_Terrain::prefetch_path(const Location &from, const Location &to, uint16_t budget)
+{
+    // sample at half the size of a grid block so that no block the
+    // path crosses is missed
+    const float step = MIN(TERRAIN_GRID_BLOCK_SPACING_X, TERRAIN_GRID_BLOCK_SPACING_Y) * grid_spacing * 0.5f;
+    const Vector2f ofs = from.get_distance_NE(to);
+    const uint16_t steps = MIN(ofs.length() / step, TERRAIN_PREFETCH_MAX_SAMPLES) + 1;
+
+    for (uint16_t i=1; i<=steps; i++) {
+        Location loc2 = from;
+        loc2.offset(ofs.x * i / steps, ofs.y * i / steps);
+        if (!prefetch_block(loc2, budget)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+  make sure the grid block for a location is in the cache, loading it
+  if needed. Returns false once the block budget or the sample limit
+  for this pass is used up
+ */
+bool AP_Terrain::prefetch_block(const Location &loc, uint16_t budget)
+{
+    if (prefetch_samples >= TERRAIN_PREFETCH_MAX_SAMPLES ||
+        prefetch_count >= budget) {
+        return false;
+    }
+    prefetch_samples++;
+
+    struct grid_info info;
+    calculate_grid_info(loc, info);
+
+    struct grid_cache &gcache = find_grid_cache(info, true);
+    if (gcache.prefetch_pass != prefetch_pass) {
+        // first time this block has been seen in this pass
+        gcache.prefetch_pass = prefetch_pass;
+        prefetch_count++;
+    }
+    return true;
+}
 #endif // AP_TERRAIN_AVAILABLE
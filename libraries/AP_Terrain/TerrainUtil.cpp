@@ -102,11 +102,16 @@ void AP_Terrain::calculate_grid_info(const Location &loc, struct grid_info &info
 
 
 /*
-  find a grid structure given a grid_info
+  find a grid structure given a grid_info. If prefetch is true then
+  the block is being loaded ahead of use, and it may only replace a
+  block that is in use if that leaves at least TERRAIN_PREFETCH_RESERVE
+  blocks that are not prefetched
  */
-AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info)
+AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info, bool prefetch)
 {
     uint16_t oldest_i = 0;
+    int16_t oldest_prefetch_i = -1;
+    uint16_t num_prefetch = 0;
 
     // see if we have that grid
     for (uint16_t i=0; i<cache_size; i++) {
@@ -114,11 +119,27 @@ AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info
             TERRAIN_LATLON_EQUAL(cache[i].grid.lon,info.grid_lon) &&
             cache[i].grid.spacing == grid_spacing) {
             cache[i].last_access_ms = AP_HAL::millis();
+            if (!prefetch) {
+                cache[i].prefetch = false;
+            }
             return cache[i];
         }
         if (cache[i].last_access_ms < cache[oldest_i].last_access_ms) {
             oldest_i = i;
         }
+        if (cache[i].prefetch) {
+            num_prefetch++;
+            if (oldest_prefetch_i == -1 ||
+                cache[i].last_access_ms < cache[oldest_prefetch_i].last_access_ms) {
+                oldest_prefetch_i = i;
+            }
+        }
+    }
+
+    if (prefetch && oldest_prefetch_i != -1 &&
+        num_prefetch + TERRAIN_PREFETCH_RESERVE >= cache_size) {
+        // replacing a block in use would eat into the reserve
+        oldest_i = oldest_prefetch_i;
     }
 
     // Not found. Use the oldest grid and make it this grid,
@@ -135,6 +156,7 @@ AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info
     grid.grid.lon_degrees = info.lon_degrees;
     grid.grid.version = TERRAIN_GRID_FORMAT_VERSION;
     grid.last_access_ms = AP_HAL::millis();
+    grid.prefetch = prefetch;
 
     // mark as waiting for disk read
     grid.state = GRID_CACHE_DISKWAIT;
@@ -143,22 +165,22 @@ AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info
 }
 
 /*
-  find cache index of disk_block
+  find cache index of a disk IO slot
  */
-int16_t AP_Terrain::find_io_idx(enum GridCacheState state)
+int16_t AP_Terrain::find_io_idx(const struct disk_io_slot &io, enum GridCacheState state)
 {
     // try first with given state
     for (uint16_t i=0; i<cache_size; i++) {
-        if (TERRAIN_LATLON_EQUAL(disk_block.block.lat,cache[i].grid.lat) &&
-            TERRAIN_LATLON_EQUAL(disk_block.block.lon,cache[i].grid.lon) &&
+        if (TERRAIN_LATLON_EQUAL(io.lat,cache[i].grid.lat) &&
+            TERRAIN_LATLON_EQUAL(io.lon,cache[i].grid.lon) &&
             cache[i].state == state) {
             return i;
         }
     }    
     // then any state
     for (uint16_t i=0; i<cache_size; i++) {
-        if (TERRAIN_LATLON_EQUAL(disk_block.block.lat,cache[i].grid.lat) &&
-            TERRAIN_LATLON_EQUAL(disk_block.block.lon,cache[i].grid.lon)) {
+        if (TERRAIN_LATLON_EQUAL(io.lat,cache[i].grid.lat) &&
+            TERRAIN_LATLON_EQUAL(io.lon,cache[i].grid.lon)) {
             return i;
         }
     }    
@@ -18,6 +18,15 @@
 #pragma GCC optimize("O2")
 #endif
 
+// keep each multiply and add of the biquad separately rounded, so the
+// notch bank gives bit identical results to NotchFilter, and to the
+// scalar bank, on targets with fused multiply-add
+#ifdef __clang__
+#pragma clang fp contract(off)
+#else
+#pragma GCC optimize("fp-contract=off")
+#endif
+
 #include "HarmonicNotchFilter.h"
 #include <GCS_MAVLink/GCS.h>
 #include <fcntl.h>
@@ -131,7 +140,9 @@ const AP_Param::GroupInfo HarmonicNotchFilterParams::var_info[] = {
  */
 template <class T>
 HarmonicNotchFilter<T>::~HarmonicNotchFilter() {
-    delete[] _filters;
+    delete[] _bank_coeffs;
+    delete[] _bank_state;
+    _bank_size = 0;
     _num_filters = 0;
     _num_enabled_filters = 0;
 }
@@ -144,7 +155,7 @@ template <class T>
 void HarmonicNotchFilter<T>::init(float sample_freq_hz, float center_freq_hz, float bandwidth_hz, float attenuation_dB)
 {
     // sanity check the input
-    if (_filters == nullptr || is_zero(sample_freq_hz) || isnan(sample_freq_hz)) {
+    if (_bank_coeffs == nullptr || is_zero(sample_freq_hz) || isnan(sample_freq_hz)) {
         return;
     }
 
@@ -176,15 +187,42 @@ void HarmonicNotchFilter<T>::allocate_filters(uint8_t num_notches, uint32_t harm
     _num_filters = _num_harmonics * num_notches * _composite_notches;
     _harmonics = harmonics;
 
-    if (_num_filters > 0) {
-        _filters = new NotchFilter<T>[_num_filters];
-        if (_filters == nullptr) {
-            GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "Failed to allocate %u bytes for notch filter", (unsigned int)(_num_filters * sizeof(NotchFilter<T>)));
-            _num_filters = 0;
-        }
+    if (_num_filters > 0 && !allocate_bank(_num_filters)) {
+        GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "Failed to allocate %u bytes for notch filter", (unsigned int)(_num_filters * (sizeof(NotchFilterCoeffs) + sizeof(BankState))));
+        _num_filters = 0;
     }
 }
 
+/*
+  allocate (or grow) the notch bank, keeping coefficients and state of
+  existing notches
+ */
+template <class T>
+bool HarmonicNotchFilter<T>::allocate_bank(uint16_t num_filters)
+{
+    auto coeffs = new NotchFilterCoeffs[num_filters];
+    auto state = new BankState[num_filters];
+    if (coeffs == nullptr || state == nullptr) {
+        delete[] coeffs;
+        delete[] state;
+        return false;
+    }
+    memset((void*)coeffs, 0, sizeof(coeffs[0])*num_filters);
+    memset((void*)state, 0, sizeof(state[0])*num_filters);
+    if (_bank_size > 0) {
+        memcpy((void*)coeffs, _bank_coeffs, sizeof(coeffs[0])*_bank_size);
+        memcpy((void*)state, _bank_state, sizeof(state[0])*_bank_size);
+    }
+    auto old_coeffs = _bank_coeffs;
+    auto old_state = _bank_state;
+    _bank_coeffs = coeffs;
+    _bank_state = state;
+    _bank_size = num_filters;
+    delete[] old_coeffs;
+    delete[] old_state;
+    return true;
+}
+
 /*
   expand the number of filters at runtime, allowing for RPM sources such as lua scripts
  */
@@ -199,16 +237,11 @@ void HarmonicNotchFilter<T>::expand_filter_count(uint16_t total_notches)
       note that we rely on the semaphore in
       AP_InertialSensor_Backend.cpp to make this thread safe
      */
-    auto filters = new NotchFilter<T>[total_notches];
-    if (filters == nullptr) {
+    if (!allocate_bank(total_notches)) {
         _alloc_has_failed = true;
         return;
     }
-    memcpy(filters, _filters, sizeof(filters[0])*_num_filters);
-    auto _old_filters = _filters;
-    _filters = filters;
     _num_filters = total_notches;
-    delete[] _old_filters;
 }
 
 /*
@@ -234,7 +267,7 @@ void HarmonicNotchFilter<T>::update(float center_freq_hz)
             if (_composite_notches != 2) {
                 // only enable the filter if its center frequency is below the nyquist frequency
                 if (notch_center < nyquist_limit) {
-                    _filters[_num_enabled_filters++].init_with_A_and_Q(_sample_freq_hz, notch_center, _A, _Q);
+                    _bank_coeffs[_num_enabled_filters++].init_with_A_and_Q(_sample_freq_hz, notch_center, _A, _Q);
                 }
             }
             if (_composite_notches > 1) {
@@ -242,12 +275,12 @@ void HarmonicNotchFilter<T>::update(float center_freq_hz)
                 // only enable the filter if its center frequency is below the nyquist frequency
                 notch_center_double = notch_center * (1.0 - _notch_spread);
                 if (notch_center_double < nyquist_limit) {
-                    _filters[_num_enabled_filters++].init_with_A_and_Q(_sample_freq_hz, notch_center_double, _A, _Q);
+                    _bank_coeffs[_num_enabled_filters++].init_with_A_and_Q(_sample_freq_hz, notch_center_double, _A, _Q);
                 }
                 // only enable the filter if its center frequency is below the nyquist frequency
                 notch_center_double = notch_center * (1.0 + _notch_spread);
                 if (notch_center_double < nyquist_limit) {
-                    _filters[_num_enabled_filters++].init_with_A_and_Q(_sample_freq_hz, notch_center_double, _A, _Q);
+                    _bank_coeffs[_num_enabled_filters++].init_with_A_and_Q(_sample_freq_hz, notch_center_double, _A, _Q);
                 }
             }
         }
@@ -290,7 +323,7 @@ void HarmonicNotchFilter<T>::update(uint8_t num_centers, const float center_freq
         if (_composite_notches != 2) {
             // only enable the filter if its center frequency is below the nyquist frequency
             if (notch_center < nyquist_limit) {
-                _filters[_num_enabled_filters++].init_with_A_and_Q(_sample_freq_hz, notch_center, _A, _Q);
+                _bank_coeffs[_num_enabled_filters++].init_with_A_and_Q(_sample_freq_hz, notch_center, _A, _Q);
             }
         }
         if (_composite_notches > 1) {
@@ -298,12 +331,12 @@ void HarmonicNotchFilter<T>::update(uint8_t num_centers, const float center_freq
             // only enable the filter if its center frequency is below the nyquist frequency
             notch_center_double = notch_center * (1.0 - _notch_spread);
             if (notch_center_double < nyquist_limit) {
-                _filters[_num_enabled_filters++].init_with_A_and_Q(_sample_freq_hz, notch_center_double, _A, _Q);
+                _bank_coeffs[_num_enabled_filters++].init_with_A_and_Q(_sample_freq_hz, notch_center_double, _A, _Q);
             }
             // only enable the filter if its center frequency is below the nyquist frequency
             notch_center_double = notch_center * (1.0 + _notch_spread);
             if (notch_center_double < nyquist_limit) {
-                _filters[_num_enabled_filters++].init_with_A_and_Q(_sample_freq_hz, notch_center_double, _A, _Q);
+                _bank_coeffs[_num_enabled_filters++].init_with_A_and_Q(_sample_freq_hz, notch_center_double, _A, _Q);
             }
         }
     }
@@ -311,6 +344,10 @@ void HarmonicNotchFilter<T>::update(uint8_t num_centers, const float center_freq
 
 /*
   apply a sample to each of the underlying filters in turn and return the output
+
+  the notches are applied from the notch bank, with all elements of
+  the sample processed together. This gives the same result as calling
+  NotchFilter::apply() on each filter in turn
  */
 template <class T>
 T HarmonicNotchFilter<T>::apply(const T &sample)
@@ -326,25 +363,134 @@ T HarmonicNotchFilter<T>::apply(const T &sample)
     }
 #endif
 
-    T output = sample;
+    static_assert(sizeof(T) <= sizeof(lanes_t), "sample must fit in notch bank lanes");
+
+    lanes_t v {};
+    memcpy((void*)&v, &sample, sizeof(T));
+
     for (uint16_t i = 0; i < _num_enabled_filters; i++) {
 #if NOTCH_DEBUG_LOGGING
-        if (!_filters[i].initialised) {
+        if (!_bank_coeffs[i].initialised) {
             ::dprintf(dfd, "------- ");
         } else {
-            ::dprintf(dfd, "%.4f ", _filters[i]._center_freq_hz);
+            ::dprintf(dfd, "%.4f ", _bank_coeffs[i]._center_freq_hz);
+        }
+#endif
+        auto &c = _bank_coeffs[i];
+        auto &st = _bank_state[i];
+        if (!c.initialised || c.need_reset) {
+            // pass the sample through and update delayed samples
+            memcpy((void*)&st.signal1, (void*)&v, sizeof(v));
+            memcpy((void*)&st.signal2, (void*)&v, sizeof(v));
+            memcpy((void*)&st.ntchsig1, (void*)&v, sizeof(v));
+            memcpy((void*)&st.ntchsig2, (void*)&v, sizeof(v));
+            c.need_reset = false;
+            continue;
+        }
+
+#if HNF_VECTOR_ENABLED
+        const lanes_t output = v*c.b0 + st.ntchsig1*c.b1 + st.ntchsig2*c.b2 - st.signal1*c.a1 - st.signal2*c.a2;
+        st.ntchsig2 = st.ntchsig1;
+        st.ntchsig1 = v;
+        st.signal2 = st.signal1;
+        st.signal1 = output;
+        v = output;
+#else
+        for (uint8_t l = 0; l < sizeof(T) / sizeof(float); l++) {
+            const float output = v[l]*c.b0 + st.ntchsig1[l]*c.b1 + st.ntchsig2[l]*c.b2 - st.signal1[l]*c.a1 - st.signal2[l]*c.a2;
+            st.ntchsig2[l] = st.ntchsig1[l];
+            st.ntchsig1[l] = v[l];
+            st.signal2[l] = st.signal1[l];
+            st.signal1[l] = output;
+            v[l] = output;
         }
 #endif
-        output = _filters[i].apply(output);
     }
 #if NOTCH_DEBUG_LOGGING
     if (_num_enabled_filters > 0) {
         ::dprintf(dfd, "\n");
     }
 #endif
+    T output;
+    memcpy((void*)&output, (void*)&v, sizeof(T));
     return output;
 }
 
+/*
+  apply a block of samples in place
+
+  each notch is run over the whole block before moving to the next,
+  keeping its coefficients and state in locals. As each notch only
+  sees the output of the one before it this gives the same result as
+  applying the samples one at a time
+ */
+template <class T>
+void HarmonicNotchFilter<T>::apply(T *samples, uint16_t count)
+{
+    if (!_initialised || count == 0) {
+        return;
+    }
+
+    for (uint16_t i = 0; i < _num_enabled_filters; i++) {
+        auto &c = _bank_coeffs[i];
+        auto &st = _bank_state[i];
+        uint16_t first = 0;
+        if (!c.initialised || c.need_reset) {
+            // the sample passes through and primes the delayed
+            // samples. An uninitialised notch passes the whole block
+            lanes_t v {};
+            memcpy((void*)&v, &samples[c.initialised ? 0 : count-1], sizeof(T));
+            memcpy((void*)&st.signal1, (void*)&v, sizeof(v));
+            memcpy((void*)&st.signal2, (void*)&v, sizeof(v));
+            memcpy((void*)&st.ntchsig1, (void*)&v, sizeof(v));
+            memcpy((void*)&st.ntchsig2, (void*)&v, sizeof(v));
+            c.need_reset = false;
+            if (!c.initialised) {
+                continue;
+            }
+            first = 1;
+        }
+
+        const float b0 = c.b0, b1 = c.b1, b2 = c.b2, a1 = c.a1, a2 = c.a2;
+#if HNF_VECTOR_ENABLED
+        lanes_t ntchsig1 = st.ntchsig1, ntchsig2 = st.ntchsig2;
+        lanes_t signal1 = st.signal1, signal2 = st.signal2;
+        for (uint16_t s = first; s < count; s++) {
+            lanes_t v {};
+            memcpy((void*)&v, &samples[s], sizeof(T));
+            const lanes_t output = v*b0 + ntchsig1*b1 + ntchsig2*b2 - signal1*a1 - signal2*a2;
+            ntchsig2 = ntchsig1;
+            ntchsig1 = v;
+            signal2 = signal1;
+            signal1 = output;
+            memcpy((void*)&samples[s], (void*)&output, sizeof(T));
+        }
+        st.ntchsig1 = ntchsig1;
+        st.ntchsig2 = ntchsig2;
+        st.signal1 = signal1;
+        st.signal2 = signal2;
+#else
+        for (uint8_t l = 0; l < sizeof(T) / sizeof(float); l++) {
+            float ntchsig1 = st.ntchsig1[l], ntchsig2 = st.ntchsig2[l];
+            float signal1 = st.signal1[l], signal2 = st.signal2[l];
+            for (uint16_t s = first; s < count; s++) {
+                float *v = ((float *)&samples[s]) + l;
+                const float output = *v*b0 + ntchsig1*b1 + ntchsig2*b2 - signal1*a1 - signal2*a2;
+                ntchsig2 = ntchsig1;
+                ntchsig1 = *v;
+                signal2 = signal1;
+                signal1 = output;
+                *v = output;
+            }
+            st.ntchsig1[l] = ntchsig1;
+            st.ntchsig2[l] = ntchsig2;
+            st.signal1[l] = signal1;
+            st.signal2[l] = signal2;
+        }
+#endif
+    }
+}
+
 /*
   reset all of the underlying filters
  */
@@ -356,7 +502,7 @@ void HarmonicNotchFilter<T>::reset()
     }
 
     for (uint16_t i = 0; i < _num_filters; i++) {
-        _filters[i].reset();
+        _bank_coeffs[i].need_reset = true;
     }
 }
 
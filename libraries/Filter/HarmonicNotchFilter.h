@@ -21,6 +21,17 @@
 
 #define HNF_MAX_HARMONICS 16
 
+// use compiler vector extensions for the notch bank where the target
+// has float SIMD; otherwise each lane is processed in turn with the
+// same operations, giving identical results
+#ifndef HNF_VECTOR_ENABLED
+#if defined(__ARM_NEON) || defined(__SSE__)
+#define HNF_VECTOR_ENABLED 1
+#else
+#define HNF_VECTOR_ENABLED 0
+#endif
+#endif
+
 /*
   a filter that manages a set of notch filters targetted at a fundamental center frequency
   and multiples of that fundamental frequency
@@ -41,12 +52,34 @@ public:
     void update(uint8_t num_centers, const float center_freq_hz[]);
     // apply a sample to each of the underlying filters in turn
     T apply(const T &sample);
+    // apply a block of samples in place, giving the same result as
+    // calling apply() on each sample in turn
+    void apply(T *samples, uint16_t count);
     // reset each of the underlying filters
     void reset();
 
 private:
-    // underlying bank of notch filters
-    NotchFilter<T>*  _filters;
+    // allocate the notch bank for num_filters, preserving existing state
+    bool allocate_bank(uint16_t num_filters);
+
+    /*
+      the notches as a structure-of-arrays bank that is applied in a
+      single pass. Each notch holds its state for the elements of T as
+      lanes, padded to four when using vector operations so that each
+      biquad term is one vector operation
+     */
+#if HNF_VECTOR_ENABLED
+    typedef float lanes_t __attribute__((vector_size(16), aligned(4)));
+#else
+    typedef float lanes_t[sizeof(T) / sizeof(float)];
+#endif
+    struct BankState {
+        lanes_t ntchsig1, ntchsig2, signal1, signal2;
+    };
+    NotchFilterCoeffs* _bank_coeffs = nullptr;
+    BankState* _bank_state = nullptr;
+    uint16_t _bank_size = 0;
+
     // sample frequency for each filter
     float _sample_freq_hz;
     // base double notch bandwidth for each filter
@@ -34,6 +34,34 @@ T DigitalBiquadFilter<T>::apply(const T &sample, const struct biquad_params &par
     return output;
 }
 
+/*
+  apply a block of samples in place, keeping the delay elements in
+  locals across the block
+ */
+template <class T>
+void DigitalBiquadFilter<T>::apply(T *samples, uint16_t count, const struct biquad_params &params) {
+    if(!is_positive(params.cutoff_freq) || !is_positive(params.sample_freq) || count == 0) {
+        return;
+    }
+
+    if (!initialised) {
+        reset(samples[0], params);
+    }
+
+    const float a1 = params.a1, a2 = params.a2;
+    const float b0 = params.b0, b1 = params.b1, b2 = params.b2;
+    T delay_element_1 = _delay_element_1;
+    T delay_element_2 = _delay_element_2;
+    for (uint16_t i = 0; i < count; i++) {
+        const T delay_element_0 = samples[i] - delay_element_1 * a1 - delay_element_2 * a2;
+        samples[i] = delay_element_0 * b0 + delay_element_1 * b1 + delay_element_2 * b2;
+        delay_element_2 = delay_element_1;
+        delay_element_1 = delay_element_0;
+    }
+    _delay_element_1 = delay_element_1;
+    _delay_element_2 = delay_element_2;
+}
+
 template <class T>
 void DigitalBiquadFilter<T>::reset() { 
     initialised = false;
@@ -105,6 +133,11 @@ T LowPassFilter2p<T>::apply(const T &sample) {
     return _filter.apply(sample, _params);
 }
 
+template <class T>
+void LowPassFilter2p<T>::apply(T *samples, uint16_t count) {
+    _filter.apply(samples, count, _params);
+}
+
 template <class T>
 void LowPassFilter2p<T>::reset(void) {
     return _filter.reset();
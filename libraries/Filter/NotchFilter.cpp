@@ -18,6 +18,14 @@
 #pragma GCC optimize("O2")
 #endif
 
+// no fused multiply-add, so HarmonicNotchFilter can match NotchFilter
+// exactly on all targets
+#ifdef __clang__
+#pragma clang fp contract(off)
+#else
+#pragma GCC optimize("fp-contract=off")
+#endif
+
 #include "NotchFilter.h"
 
 const static float NOTCH_MAX_SLEW       = 0.05f;
@@ -55,8 +63,7 @@ void NotchFilter<T>::init(float sample_freq_hz, float center_freq_hz, float band
     }
 }
 
-template <class T>
-void NotchFilter<T>::init_with_A_and_Q(float sample_freq_hz, float center_freq_hz, float A, float Q)
+void NotchFilterCoeffs::init_with_A_and_Q(float sample_freq_hz, float center_freq_hz, float A, float Q)
 {
     // don't update if no updates required
     if (initialised && is_equal(center_freq_hz, _center_freq_hz) && is_equal(sample_freq_hz, _sample_freq_hz)) {
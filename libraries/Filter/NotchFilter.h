@@ -29,26 +29,38 @@
 template <class T>
 class HarmonicNotchFilter;
 
+/*
+  coefficients of a notch filter, and the center frequency they were
+  calculated for so that changes can be slew limited. The notch bank
+  of HarmonicNotchFilter holds these without the filter state
+ */
+class NotchFilterCoeffs {
+public:
+    template <class T> friend class HarmonicNotchFilter;
+    void init_with_A_and_Q(float sample_freq_hz, float center_freq_hz, float A, float Q);
+    float center_freq_hz() const { return _center_freq_hz; }
+    float sample_freq_hz() const { return _sample_freq_hz; }
+
+protected:
+
+    bool initialised, need_reset;
+    float b0, b1, b2, a1, a2;
+    float _center_freq_hz, _sample_freq_hz;
+};
+
 template <class T>
-class NotchFilter {
+class NotchFilter : public NotchFilterCoeffs {
 public:
-    friend class HarmonicNotchFilter<T>;
     // set parameters
     void init(float sample_freq_hz, float center_freq_hz, float bandwidth_hz, float attenuation_dB);
-    void init_with_A_and_Q(float sample_freq_hz, float center_freq_hz, float A, float Q);
     T apply(const T &sample);
     void reset();
-    float center_freq_hz() const { return _center_freq_hz; }
-    float sample_freq_hz() const { return _sample_freq_hz; }
 
     // calculate attenuation and quality from provided center frequency and bandwidth
     static void calculate_A_and_Q(float center_freq_hz, float bandwidth_hz, float attenuation_dB, float& A, float& Q); 
 
 protected:
 
-    bool initialised, need_reset;
-    float b0, b1, b2, a1, a2;
-    float _center_freq_hz, _sample_freq_hz;
     T ntchsig1, ntchsig2, signal2, signal1;
 };
 
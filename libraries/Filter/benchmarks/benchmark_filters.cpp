@@ -0,0 +1,260 @@
+/*
+  benchmarks for the filters used in the IMU fast loop
+
+  Each iteration filters one second of samples at the given sample
+  rate through the given number of filters, so items_per_second is
+  samples per second per filter and the time per iteration is the CPU
+  cost of one second of data.
+
+  Results are written to benchmark_filters.json for regression
+  tracking unless --benchmark_out is given on the command line
+ */
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <Filter/LowPassFilter2p.h>
+#include <Filter/NotchFilter.h>
+#include <Filter/HarmonicNotchFilter.h>
+#include <Filter/DerivativeFilter.h>
+#include <Filter/ModeFilter.h>
+#include <Filter/SlewLimiter.h>
+
+#include <string.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// largest sample rate and filter count benchmarked
+#define BENCH_MAX_RATE_HZ 8000
+#define BENCH_MAX_FILTERS 8
+
+/*
+  one second of gyro-like data: a 1Hz motion plus motor noise at 80Hz
+  and its harmonics
+ */
+static Vector3f gyro_samples[BENCH_MAX_RATE_HZ];
+static uint16_t gyro_samples_rate_hz;
+
+static const Vector3f *get_samples(uint16_t rate_hz)
+{
+    if (gyro_samples_rate_hz != rate_hz) {
+        for (uint16_t i=0; i<rate_hz; i++) {
+            const float t = float(i) / rate_hz;
+            const float noise = sinf(t * M_2PI * 80) + 0.5 * sinf(t * M_2PI * 160) + 0.25 * sinf(t * M_2PI * 240);
+            gyro_samples[i] = Vector3f(sinf(t * M_2PI) + noise,
+                                       cosf(t * M_2PI) - noise,
+                                       0.1 * noise);
+        }
+        gyro_samples_rate_hz = rate_hz;
+    }
+    return gyro_samples;
+}
+
+// sweep of sample rates and filter counts
+static void rate_and_count_args(benchmark::internal::Benchmark *b)
+{
+    for (int rate : {1000, 2000, 4000, 8000}) {
+        for (int count : {1, 3, BENCH_MAX_FILTERS}) {
+            b->Args({rate, count});
+        }
+    }
+}
+
+static void BM_LowPassFilter2pVector3f(benchmark::State& state)
+{
+    const uint16_t rate_hz = state.range(0);
+    const uint8_t count = state.range(1);
+    const Vector3f *samples = get_samples(rate_hz);
+    LowPassFilter2pVector3f filters[BENCH_MAX_FILTERS];
+    for (uint8_t f=0; f<count; f++) {
+        filters[f].set_cutoff_frequency(rate_hz, 20);
+    }
+
+    while (state.KeepRunning()) {
+        for (uint16_t i=0; i<rate_hz; i++) {
+            for (uint8_t f=0; f<count; f++) {
+                Vector3f v = filters[f].apply(samples[i]);
+                gbenchmark_escape(&v);
+            }
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * rate_hz * count);
+}
+
+BENCHMARK(BM_LowPassFilter2pVector3f)->Apply(rate_and_count_args);
+
+static void BM_NotchFilterVector3f(benchmark::State& state)
+{
+    const uint16_t rate_hz = state.range(0);
+    const uint8_t count = state.range(1);
+    const Vector3f *samples = get_samples(rate_hz);
+    NotchFilterVector3f filters[BENCH_MAX_FILTERS];
+    for (uint8_t f=0; f<count; f++) {
+        filters[f].init(rate_hz, 80, 40, 40);
+    }
+
+    while (state.KeepRunning()) {
+        for (uint16_t i=0; i<rate_hz; i++) {
+            for (uint8_t f=0; f<count; f++) {
+                Vector3f v = filters[f].apply(samples[i]);
+                gbenchmark_escape(&v);
+            }
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * rate_hz * count);
+}
+
+BENCHMARK(BM_NotchFilterVector3f)->Apply(rate_and_count_args);
+
+/*
+  harmonic notch with range(1) harmonics, range(2) composite notches
+  and range(3) dynamic notch centers (one per motor), with the
+  centers updated at 200Hz as the main loop does
+ */
+static void BM_HarmonicNotchFilterVector3f(benchmark::State& state)
+{
+    const uint16_t rate_hz = state.range(0);
+    const uint8_t num_harmonics = state.range(1);
+    const uint8_t composite_notches = state.range(2);
+    const uint8_t num_centers = state.range(3);
+    const Vector3f *samples = get_samples(rate_hz);
+
+    HarmonicNotchFilterVector3f filter {};
+    filter.allocate_filters(num_centers, (1U<<num_harmonics)-1, composite_notches);
+    filter.init(rate_hz, 80, 40, 40);
+
+    float centers[BENCH_MAX_FILTERS];
+    const uint16_t update_interval = rate_hz / 200;
+    uint32_t nupdates = 0;
+
+    while (state.KeepRunning()) {
+        for (uint16_t i=0; i<rate_hz; i++) {
+            if (i % update_interval == 0) {
+                for (uint8_t c=0; c<num_centers; c++) {
+                    centers[c] = 80 + c + (nupdates % 10);
+                }
+                nupdates++;
+                filter.update(num_centers, centers);
+            }
+            Vector3f v = filter.apply(samples[i]);
+            gbenchmark_escape(&v);
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * rate_hz);
+}
+
+static void harmonic_notch_args(benchmark::internal::Benchmark *b)
+{
+    for (int rate : {1000, 2000, 4000, 8000}) {
+        // single notch, triple notch and per-motor notches on a quad
+        b->Args({rate, 1, 1, 1});
+        b->Args({rate, 3, 1, 1});
+        b->Args({rate, 3, 2, 1});
+        b->Args({rate, 3, 1, 4});
+        b->Args({rate, 4, 3, 4});
+    }
+}
+
+BENCHMARK(BM_HarmonicNotchFilterVector3f)->Apply(harmonic_notch_args);
+
+static void BM_DerivativeFilterFloat_Size7(benchmark::State& state)
+{
+    const uint16_t rate_hz = state.range(0);
+    const uint8_t count = state.range(1);
+    const Vector3f *samples = get_samples(rate_hz);
+    DerivativeFilterFloat_Size7 filters[BENCH_MAX_FILTERS];
+    const uint32_t dt_us = 1000000UL / rate_hz;
+    uint32_t t_us = 0;
+
+    while (state.KeepRunning()) {
+        for (uint16_t i=0; i<rate_hz; i++) {
+            t_us += dt_us;
+            for (uint8_t f=0; f<count; f++) {
+                filters[f].update(samples[i].x, t_us);
+                float v = filters[f].slope();
+                gbenchmark_escape(&v);
+            }
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * rate_hz * count);
+}
+
+BENCHMARK(BM_DerivativeFilterFloat_Size7)->Apply(rate_and_count_args);
+
+static void BM_ModeFilterFloat_Size5(benchmark::State& state)
+{
+    const uint16_t rate_hz = state.range(0);
+    const uint8_t count = state.range(1);
+    const Vector3f *samples = get_samples(rate_hz);
+    // return the median of 5 samples
+    ModeFilterFloat_Size5 filters[BENCH_MAX_FILTERS] {{2}, {2}, {2}, {2}, {2}, {2}, {2}, {2}};
+
+    while (state.KeepRunning()) {
+        for (uint16_t i=0; i<rate_hz; i++) {
+            for (uint8_t f=0; f<count; f++) {
+                float v = filters[f].apply(samples[i].y);
+                gbenchmark_escape(&v);
+            }
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * rate_hz * count);
+}
+
+BENCHMARK(BM_ModeFilterFloat_Size5)->Apply(rate_and_count_args);
+
+static void BM_SlewLimiter(benchmark::State& state)
+{
+    const uint16_t rate_hz = state.range(0);
+    const uint8_t count = state.range(1);
+    const Vector3f *samples = get_samples(rate_hz);
+    const float slew_rate_max = 100;
+    const float slew_rate_tau = 1;
+    SlewLimiter limiters[BENCH_MAX_FILTERS] {
+        {slew_rate_max, slew_rate_tau}, {slew_rate_max, slew_rate_tau},
+        {slew_rate_max, slew_rate_tau}, {slew_rate_max, slew_rate_tau},
+        {slew_rate_max, slew_rate_tau}, {slew_rate_max, slew_rate_tau},
+        {slew_rate_max, slew_rate_tau}, {slew_rate_max, slew_rate_tau},
+    };
+    const float dt = 1.0 / rate_hz;
+
+    while (state.KeepRunning()) {
+        for (uint16_t i=0; i<rate_hz; i++) {
+            for (uint8_t f=0; f<count; f++) {
+                float v = limiters[f].modifier(samples[i].z, dt);
+                gbenchmark_escape(&v);
+            }
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * rate_hz * count);
+}
+
+BENCHMARK(BM_SlewLimiter)->Apply(rate_and_count_args);
+
+/*
+  run the benchmarks, writing JSON results to benchmark_filters.json
+  unless an output file is given
+ */
+int main(int argc, char **argv)
+{
+    bool have_out = false;
+    for (int i=1; i<argc; i++) {
+        if (strncmp(argv[i], "--benchmark_out=", 16) == 0) {
+            have_out = true;
+        }
+    }
+    char out_arg[] = "--benchmark_out=benchmark_filters.json";
+    char out_format_arg[] = "--benchmark_out_format=json";
+    char **args = new char*[argc+2];
+    for (int i=0; i<argc; i++) {
+        args[i] = argv[i];
+    }
+    int nargs = argc;
+    if (!have_out) {
+        args[nargs++] = out_arg;
+        args[nargs++] = out_format_arg;
+    }
+
+    benchmark::Initialize(&nargs, args);
+    benchmark::RunSpecifiedBenchmarks();
+    delete[] args;
+    return 0;
+}
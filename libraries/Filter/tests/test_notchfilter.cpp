@@ -3,6 +3,7 @@
 #include <Filter/Filter.h>
 #include <Filter/NotchFilter.h>
 #include <Filter/HarmonicNotchFilter.h>
+#include <Filter/LowPassFilter2p.h>
 
 const AP_HAL::HAL& hal = AP_HAL::get_HAL();
 
@@ -156,4 +157,107 @@ TEST(NotchFilterTest, HarmonicNotchTest)
     EXPECT_NEAR(integrals[9].get_lag_degrees(10), 112.23, 0.5);
 }
 
+/*
+  test that the harmonic notch gives bit identical results to applying
+  each of its notches as a separate NotchFilter, including across a
+  reset
+ */
+TEST(NotchFilterTest, HarmonicNotchCascadeTest)
+{
+    const float rate_hz = 2000;
+    const float base_freq = 80;
+    const float bandwidth = 40;
+    const float attenuation_dB = 30;
+    const uint32_t harmonics = 0x0B;
+    const uint8_t num_harmonics = __builtin_popcount(harmonics);
+
+    HarmonicNotchFilter<Vector3f> hnotch {};
+    hnotch.allocate_filters(1, harmonics, 2);
+    hnotch.init(rate_hz, base_freq, bandwidth, attenuation_dB);
+
+    float A, Q;
+    NotchFilter<Vector3f>::calculate_A_and_Q(base_freq, bandwidth / 2, attenuation_dB, A, Q);
+    const float spread = bandwidth / (32 * base_freq);
+
+    NotchFilter<Vector3f> notches[num_harmonics*2] {};
+    uint8_t n = 0;
+    for (uint8_t h = 0; h < 8; h++) {
+        if (harmonics & (1U<<h)) {
+            const float freq = base_freq * (h+1);
+            notches[n++].init_with_A_and_Q(rate_hz, freq * (1.0 - spread), A, Q);
+            notches[n++].init_with_A_and_Q(rate_hz, freq * (1.0 + spread), A, Q);
+        }
+    }
+
+    for (uint32_t s=0; s<2000; s++) {
+        if (s == 1000) {
+            hnotch.reset();
+            for (auto &f : notches) {
+                f.reset();
+            }
+        }
+        const float t = s / rate_hz;
+        const Vector3f sample { sinf(t * 2 * M_PI * base_freq),
+                                0.5f * cosf(t * 2 * M_PI * base_freq * 2),
+                                sinf(t * 2 * M_PI * 13) };
+        Vector3f expected = sample;
+        for (auto &f : notches) {
+            expected = f.apply(expected);
+        }
+        const Vector3f v = hnotch.apply(sample);
+        EXPECT_EQ(v.x, expected.x);
+        EXPECT_EQ(v.y, expected.y);
+        EXPECT_EQ(v.z, expected.z);
+    }
+}
+
+/*
+  test that filtering a block of samples gives the same result as
+  filtering them one at a time, including across resets and
+  frequency updates
+ */
+TEST(NotchFilterTest, HarmonicNotchBlockTest)
+{
+    const uint16_t rate_hz = 2000;
+    const float base_freq = 80;
+    HarmonicNotchFilter<Vector3f> single {}, block {};
+    LowPassFilter2pVector3f single_lpf, block_lpf;
+    for (auto *f : { &single, &block }) {
+        f->allocate_filters(1, 7, 2);
+        f->init(rate_hz, base_freq, base_freq/2, 40);
+    }
+    for (auto *f : { &single_lpf, &block_lpf }) {
+        f->set_cutoff_frequency(rate_hz, 120);
+        f->reset();
+    }
+
+    uint32_t s = 0;
+    for (uint8_t n = 1; n <= 32; n++) {
+        if (n == 10) {
+            single.reset();
+            block.reset();
+        }
+        if (n == 20) {
+            single.update(base_freq*1.5);
+            block.update(base_freq*1.5);
+        }
+        Vector3f samples[32];
+        Vector3f expected[32];
+        for (uint8_t i = 0; i < n; i++, s++) {
+            const float t = s / float(rate_hz);
+            samples[i] = Vector3f(sinf(base_freq * t * 2 * M_PI),
+                                  0.5 * sinf(37 * t * 2 * M_PI),
+                                  0.2 + 0.1 * sinf(300 * t * 2 * M_PI));
+            expected[i] = single_lpf.apply(single.apply(samples[i]));
+        }
+        block.apply(samples, n);
+        block_lpf.apply(samples, n);
+        for (uint8_t i = 0; i < n; i++) {
+            EXPECT_FLOAT_EQ(samples[i].x, expected[i].x);
+            EXPECT_FLOAT_EQ(samples[i].y, expected[i].y);
+            EXPECT_FLOAT_EQ(samples[i].z, expected[i].z);
+        }
+    }
+}
+
 AP_GTEST_MAIN()
@@ -0,0 +1,8 @@
+/*
+  run the notch filter tests against the scalar notch bank used on
+  targets without float SIMD. The harmonic notch is compiled into this
+  test with HNF_VECTOR_ENABLED set to 0, in place of the library build
+ */
+#define HNF_VECTOR_ENABLED 0
+#include "../HarmonicNotchFilter.cpp"
+#include "test_notchfilter.cpp"
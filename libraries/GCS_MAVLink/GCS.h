@@ -1002,12 +1002,21 @@ private:
         int16_t current_session;
         uint32_t last_send_ms;
         uint8_t need_banner_send_mask;
+#if AP_MAVLINK_FTP_READAHEAD_SIZE > 0
+        // read-ahead window holding file data from readahead_offset
+        uint8_t *readahead;
+        uint32_t readahead_offset;
+        uint16_t readahead_len;
+#endif
     };
     static struct ftp_state ftp;
 
     static void ftp_error(struct pending_ftp &response, FTP_ERROR error); // FTP helper method for packing a NAK
     static int gen_dir_entry(char *dest, size_t space, const char * path, const struct dirent * entry); // FTP helper for emitting a dir response
     static void ftp_list_dir(struct pending_ftp &request, struct pending_ftp &response);
+    static ssize_t ftp_read(uint32_t offset, uint8_t *buf, uint16_t count);
+    static void ftp_close_file(void);
+    static uint32_t ftp_tx_wait_us(mavlink_channel_t chan);
 
     bool ftp_init(void);
     void handle_file_transfer_protocol(const mavlink_message_t &msg);
@@ -152,12 +152,87 @@ void GCS_MAVLINK::ftp_error(struct pending_ftp &response, FTP_ERROR error) {
     }
 }
 
+/*
+  time to wait for transmit space, about the time the link takes to
+  send one reply
+ */
+uint32_t GCS_MAVLINK::ftp_tx_wait_us(mavlink_channel_t chan)
+{
+    uint32_t wait_us = 2000;
+    if (valid_channel(chan)) {
+        auto *port = mavlink_comm_port[chan];
+        const uint32_t bw = port != nullptr ? port->bw_in_bytes_per_second() : 0;
+        if (bw > 0) {
+            wait_us = constrain_uint32(PAYLOAD_SIZE(chan, FILE_TRANSFER_PROTOCOL) * 1000000ULL / bw, 100, 2000);
+        }
+    }
+    return wait_us;
+}
+
 // send our response back out to the system
 void GCS_MAVLINK::ftp_push_replies(pending_ftp &reply)
 {
     while (!send_ftp_reply(reply)) {
-        hal.scheduler->delay(2);
+        hal.scheduler->delay_microseconds(ftp_tx_wait_us(reply.chan));
+    }
+}
+
+/*
+  close the session's file and release the read-ahead window
+ */
+void GCS_MAVLINK::ftp_close_file(void)
+{
+    if (ftp.fd != -1) {
+        AP::FS().close(ftp.fd);
+        ftp.fd = -1;
     }
+#if AP_MAVLINK_FTP_READAHEAD_SIZE > 0
+    free(ftp.readahead);
+    ftp.readahead = nullptr;
+    ftp.readahead_len = 0;
+#endif
+}
+
+/*
+  read from the open file at offset. Reads go through the read-ahead
+  window when we have one. The window is filled synchronously on the
+  FTP thread when a request falls outside it, so file IO is batched
+  into large reads but does not overlap with sending the replies
+ */
+ssize_t GCS_MAVLINK::ftp_read(uint32_t offset, uint8_t *buf, uint16_t count)
+{
+#if AP_MAVLINK_FTP_READAHEAD_SIZE > 0
+    if (ftp.readahead == nullptr) {
+        ftp.readahead = (uint8_t *)malloc(AP_MAVLINK_FTP_READAHEAD_SIZE);
+    }
+    if (ftp.readahead != nullptr && count <= AP_MAVLINK_FTP_READAHEAD_SIZE) {
+        if (offset < ftp.readahead_offset ||
+            offset + count > ftp.readahead_offset + ftp.readahead_len) {
+            // refill the window starting at the requested offset. A
+            // short window at the end of the file is refilled each time
+            // so that we see data appended to files still being written
+            ftp.readahead_len = 0;
+            if (AP::FS().lseek(ftp.fd, offset, SEEK_SET) == -1) {
+                return -1;
+            }
+            const ssize_t read_bytes = AP::FS().read(ftp.fd, ftp.readahead, AP_MAVLINK_FTP_READAHEAD_SIZE);
+            if (read_bytes == -1) {
+                return -1;
+            }
+            ftp.readahead_offset = offset;
+            ftp.readahead_len = read_bytes;
+        }
+        const uint32_t window_ofs = offset - ftp.readahead_offset;
+        const uint16_t n = MIN(uint32_t(count), ftp.readahead_len - window_ofs);
+        memcpy(buf, &ftp.readahead[window_ofs], n);
+        return n;
+    }
+#endif
+
+    if (AP::FS().lseek(ftp.fd, offset, SEEK_SET) == -1) {
+        return -1;
+    }
+    return AP::FS().read(ftp.fd, buf, count);
 }
 
 void GCS_MAVLINK::ftp_worker(void) {
@@ -215,8 +290,7 @@ void GCS_MAVLINK::ftp_worker(void) {
                 // if a new session appears and the old session has
                 // been idle for more than the timeout then force
                 // close the old session
-                AP::FS().close(ftp.fd);
-                ftp.fd = -1;
+                ftp_close_file();
                 ftp.current_session = -1;
             }
             // dispatch the command as needed
@@ -227,10 +301,7 @@ void GCS_MAVLINK::ftp_worker(void) {
                 case FTP_OP::TerminateSession:
                 case FTP_OP::ResetSessions:
                     // we already handled this, just listed for completeness
-                    if (ftp.fd != -1) {
-                        AP::FS().close(ftp.fd);
-                        ftp.fd = -1;
-                    }
+                    ftp_close_file();
                     ftp.current_session = -1;
                     reply.opcode = FTP_OP::Ack;
                     break;
@@ -244,8 +315,7 @@ void GCS_MAVLINK::ftp_worker(void) {
                             // no activity for 3s, assume client has
                             // timed out receiving open reply, close
                             // the file
-                            AP::FS().close(ftp.fd);
-                            ftp.fd = -1;
+                            ftp_close_file();
                             ftp.current_session = -1;
                         }
                         if (ftp.fd != -1) {
@@ -278,6 +348,9 @@ void GCS_MAVLINK::ftp_worker(void) {
                         }
                         ftp.mode = FTP_FILE_MODE::Read;
                         ftp.current_session = request.session;
+#if AP_MAVLINK_FTP_READAHEAD_SIZE > 0
+                        ftp.readahead_len = 0;
+#endif
 
                         reply.opcode = FTP_OP::Ack;
                         reply.size = sizeof(uint32_t);
@@ -303,14 +376,8 @@ void GCS_MAVLINK::ftp_worker(void) {
                             break;
                         }
 
-                        // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-
                         // fill the buffer
-                        const ssize_t read_bytes = AP::FS().read(ftp.fd, reply.data, MIN(sizeof(reply.data),request.size));
+                        const ssize_t read_bytes = ftp_read(request.offset, reply.data, MIN(sizeof(reply.data),request.size));
                         if (read_bytes == -1) {
                             ftp_error(reply, FTP_ERROR::FailErrno);
                             break;
@@ -472,35 +539,33 @@ void GCS_MAVLINK::ftp_worker(void) {
                             break;
                         }
 
-                        // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
-
                         /*
-                          calculate a burst delay so that FTP burst
-                          transfer doesn't use more than 1/3 of
-                          available bandwidth on links that don't have
-                          flow control. This reduces the chance of
-                          lost packets a lot, which results in overall
-                          faster transfers
+                          pace the burst so that FTP burst transfer
+                          doesn't use more than 1/3 of available
+                          bandwidth on links that don't have flow
+                          control. This reduces the chance of lost
+                          packets a lot, which results in overall
+                          faster transfers. Other links are fed as
+                          fast as they have transmit space
                          */
-                        uint32_t burst_delay_ms = 0;
+                        uint32_t burst_bw = 0;
+                        uint16_t pkt_size = 0;
                         if (valid_channel(request.chan)) {
                             auto *port = mavlink_comm_port[request.chan];
                             if (port != nullptr && port->get_flow_control() != AP_HAL::UARTDriver::FLOW_CONTROL_ENABLE) {
-                                const uint32_t bw = port->bw_in_bytes_per_second();
-                                const uint16_t pkt_size = PAYLOAD_SIZE(request.chan, FILE_TRANSFER_PROTOCOL) - (sizeof(reply.data) - max_read);
-                                burst_delay_ms = 3000 * pkt_size / bw;
+                                burst_bw = port->bw_in_bytes_per_second() / 3;
+                                pkt_size = PAYLOAD_SIZE(request.chan, FILE_TRANSFER_PROTOCOL) - (sizeof(reply.data) - max_read);
                             }
                         }
+                        const uint32_t burst_start_us = AP_HAL::micros();
+                        uint32_t burst_bytes = 0;
 
                         // this transfer size is enough for a full parameter file with max parameters
                         const uint32_t transfer_size = 500;
+                        uint32_t offset = request.offset;
                         for (uint32_t i = 0; (i < transfer_size); i++) {
                             // fill the buffer
-                            const ssize_t read_bytes = AP::FS().read(ftp.fd, reply.data, MIN(sizeof(reply.data), max_read));
+                            const ssize_t read_bytes = ftp_read(offset, reply.data, MIN(sizeof(reply.data), max_read));
                             if (read_bytes == -1) {
                                 ftp_error(reply, FTP_ERROR::FailErrno);
                                 break;
@@ -517,21 +582,35 @@ void GCS_MAVLINK::ftp_worker(void) {
                             }
 
                             reply.opcode = FTP_OP::Ack;
-                            reply.offset = request.offset + i * max_read;
+                            reply.offset = offset;
                             reply.burst_complete = (i == (transfer_size - 1));
                             reply.size = (uint8_t)read_bytes;
 
                             ftp_push_replies(reply);
 
+                            offset += read_bytes;
                             if (read_bytes < max_read) {
                                 // ensure the NACK which we send next is at the right offset
-                                reply.offset += read_bytes;
+                                reply.offset = offset;
                             }
 
                             // prep the reply to be used again
                             reply.seq_number++;
 
-                            hal.scheduler->delay(burst_delay_ms);
+                            if (burst_bw > 0) {
+                                // sleep only while ahead of the bandwidth budget
+                                burst_bytes += pkt_size;
+                                const uint32_t due_us = uint64_t(burst_bytes) * 1000000ULL / burst_bw;
+                                const uint32_t elapsed_us = AP_HAL::micros() - burst_start_us;
+                                if (due_us > elapsed_us) {
+                                    const uint32_t wait_us = due_us - elapsed_us;
+                                    if (wait_us >= 1000) {
+                                        hal.scheduler->delay(wait_us / 1000);
+                                    } else {
+                                        hal.scheduler->delay_microseconds(wait_us);
+                                    }
+                                }
+                            }
                         }
 
                         if (reply.opcode != FTP_OP::Nack) {
@@ -76,6 +76,21 @@
 #define AP_MAVLINK_SERVO_RELAY_ENABLED HAL_GCS_ENABLED && AP_SERVORELAYEVENTS_ENABLED
 #endif
 
+// size of the window MAVFTP reads files through. Burst reads are
+// served from it, replacing a seek and small read per packet with one
+// large read per window. The window is refilled synchronously, it does
+// not overlap file reads with sending, and is freed when the file is
+// closed
+#ifndef AP_MAVLINK_FTP_READAHEAD_SIZE
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_1000
+#define AP_MAVLINK_FTP_READAHEAD_SIZE 32768
+#elif HAL_MEM_CLASS >= HAL_MEM_CLASS_500
+#define AP_MAVLINK_FTP_READAHEAD_SIZE 8192
+#else
+#define AP_MAVLINK_FTP_READAHEAD_SIZE 0
+#endif
+#endif
+
 #ifndef AP_MAVLINK_MSG_SERIAL_CONTROL_ENABLED
 #define AP_MAVLINK_MSG_SERIAL_CONTROL_ENABLED HAL_GCS_ENABLED
 #endif
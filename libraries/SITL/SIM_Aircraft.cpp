@@ -281,7 +281,10 @@ void Aircraft::sync_frame_time(void)
         // don't let a large negative debt build up
         sleep_debt_us = -1.0e5;
     }
-    if (sleep_debt_us > min_sleep_time) {
+    if (lockstep) {
+        // never sleep, the firmware paces us
+        sleep_debt_us = 0;
+    } else if (sleep_debt_us > min_sleep_time) {
         // sleep if we have built up a debt of min_sleep_tim
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
         usleep(sleep_debt_us);
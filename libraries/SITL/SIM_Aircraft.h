@@ -56,6 +56,14 @@ public:
     void set_speedup(float speedup);
     float get_speedup() const { return target_speedup; }
 
+    /*
+      run physics as fast as the firmware consumes it, without pacing
+      against the wall clock
+     */
+    void set_lockstep(bool enable) {
+        lockstep = enable;
+    }
+
     /*
       set instance number
      */
@@ -239,6 +247,7 @@ protected:
     const char *autotest_dir;
     const char *frame;
     bool use_time_sync = true;
+    bool lockstep = false;
     float last_speedup = -1.0f;
     const char *config_ = "";
 